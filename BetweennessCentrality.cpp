@@ -0,0 +1,297 @@
+/*-------------------------------------------------------------------------
+  BetweennessCentrality.cpp
+
+  - Implementation of the non-template functions mentioned in BetweennessCentrality.h
+------------------------------------------------------------------------*/
+#include "BetweennessCentrality.h"
+#include "ParallelChunks.h"
+#include "TraversalWorkspace.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+    /*-----------------------------------------------------------------------
+        Mix the bits of a 64-bit value (splitmix64 finalizer).
+    -----------------------------------------------------------------------*/
+    uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    /***** Sample Random (random numbers of one sample) *****/
+    // Seeded by the seed and the sample's index, so a sample draws the
+    // same numbers whichever thread runs it.
+    struct SampleRandom {
+        uint64_t state;
+
+        SampleRandom(uint64_t seed, int sample) : state(mix(seed) + (uint64_t)sample * 0x9E3779B97F4A7C15ULL) {}
+
+        uint64_t next() {
+            state += 0x9E3779B97F4A7C15ULL;
+            return mix(state);
+        }
+
+        int below(int bound) { return (int)(next() % (uint64_t)bound); }
+
+        double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    };
+}
+
+/*-----------------------------------------------------------------------
+    Estimate betweenness by sampling shortest paths.
+
+    Postcondition: Each sample runs a balanced bidirectional BFS, which
+                   on a small-world graph meets after reaching far fewer
+                   people than a BFS from one end. The path is then walked
+                   back from the meeting person to both ends, choosing each
+                   predecessor by its share of the path count.
+-----------------------------------------------------------------------*/
+vector<double> BetweennessCentrality::approximate(const Options& options) const {
+    int count = nodeCount();
+    int n = (int)lists.people.size();
+    vector<double> scores(count, 0.0);
+    if (n < 3) return scores;
+
+    int samples = options.samples;
+    if (samples <= 0) {
+        int diameter = vertexDiameterBound();
+        double bits = diameter > 3 ? floor(log2((double)diameter - 2)) : 0.0;
+        double epsilon = options.epsilon;
+        samples = (int)ceil((bits + 1 + log(1 / options.delta)) / (2 * epsilon * epsilon));
+    }
+
+    int threadCount = ParallelChunks::threadsFor(samples, options.threadCount, 1);
+    vector<vector<int>> hits(threadCount, vector<int>(count, 0));
+    vector<vector<double>> sourceCounts(threadCount, vector<double>(count, 0.0));
+    vector<vector<double>> targetCounts(threadCount, vector<double>(count, 0.0));
+    ParallelChunks::run(samples, threadCount, [&](int self, int first, int end) {
+        vector<int>& hit = hits[self];
+        for (int sample = first; sample < end; sample++) {
+            SampleRandom random(options.seed, sample);
+            int sourceIndex = random.below(n), targetIndex = random.below(n - 1);
+            if (targetIndex >= sourceIndex) targetIndex++;
+
+            // Side 0 searches from the source, side 1 from the target. Each
+            // queue holds whole levels; levelStart marks the newest one.
+            TraversalWorkspace::Lease fromSource = TraversalWorkspace::acquire(count);
+            TraversalWorkspace::Lease fromTarget = TraversalWorkspace::acquire(count);
+            TraversalWorkspace* ws[2] = { &*fromSource, &*fromTarget };
+            vector<double>* sigma[2] = { &sourceCounts[self], &targetCounts[self] };
+            int ends[2] = { lists.people[sourceIndex], lists.people[targetIndex] };
+            size_t levelStart[2] = { 0, 0 };
+            int64_t work[2];
+            for (int side = 0; side < 2; side++) {
+                ws[side]->visit(ends[side], -1, 0);
+                (*sigma[side])[ends[side]] = 1.0;
+                ws[side]->queue().push_back(ends[side]);
+                work[side] = lists.degree(ends[side]);
+            }
+
+            // Grow the side whose next level costs less until the two meet
+            int side = 0;
+            bool met = false;
+            while (!met) {
+                side = work[0] <= work[1] ? 0 : 1;
+                TraversalWorkspace& reached = *ws[side];
+                vector<double>& counts = *sigma[side];
+                vector<int>& queue = reached.queue();
+                size_t begin = levelStart[side], stop = queue.size();
+                if (begin == stop) break;
+                levelStart[side] = stop;
+                work[side] = 0;
+                for (size_t i = begin; i < stop; i++) {
+                    int v = queue[i], next = reached.distance(v) + 1;
+                    for (int j = lists.offsets[v]; j < lists.offsets[v + 1]; j++) {
+                        int u = lists.targets[j];
+                        if (!reached.visited(u)) {
+                            reached.visit(u, v, next);
+                            counts[u] = counts[v];
+                            queue.push_back(u);
+                            work[side] += lists.degree(u);
+                            if (ws[1 - side]->visited(u)) met = true;
+                        } else if (reached.distance(u) == next) {
+                            counts[u] += counts[v];
+                        }
+                    }
+                }
+            }
+            if (!met) continue;
+
+            // Every shortest path crosses the newest level at exactly one
+            // person the other side has reached; pick one by path count
+            vector<int>& queue = ws[side]->queue();
+            double total = 0.0;
+            for (size_t i = levelStart[side]; i < queue.size(); i++) {
+                int u = queue[i];
+                if (ws[1 - side]->visited(u)) total += (*sigma[0])[u] * (*sigma[1])[u];
+            }
+            double pick = random.unit() * total;
+            int middle = -1;
+            for (size_t i = levelStart[side]; i < queue.size(); i++) {
+                int u = queue[i];
+                if (!ws[1 - side]->visited(u)) continue;
+                middle = u;
+                pick -= (*sigma[0])[u] * (*sigma[1])[u];
+                if (pick < 0) break;
+            }
+
+            // Walk back to both ends, choosing predecessors by path count
+            if (middle != ends[0] && middle != ends[1]) hit[middle]++;
+            for (int back = 0; back < 2; back++) {
+                TraversalWorkspace& reached = *ws[back];
+                vector<double>& counts = *sigma[back];
+                for (int w = middle; w != ends[back]; ) {
+                    double share = random.unit() * counts[w];
+                    int chosen = -1;
+                    for (int j = lists.offsets[w]; j < lists.offsets[w + 1]; j++) {
+                        int p = lists.targets[j];
+                        if (!reached.visited(p) || reached.distance(p) != reached.distance(w) - 1) continue;
+                        chosen = p;
+                        share -= counts[p];
+                        if (share < 0) break;
+                    }
+                    if (chosen != ends[back]) hit[chosen]++;
+                    w = chosen;
+                }
+            }
+        }
+    });
+
+    for (const vector<int>& hit : hits) {
+        for (int id = 0; id < count; id++) {
+            scores[id] += hit[id];
+        }
+    }
+    for (double& score : scores) {
+        score /= samples;
+    }
+    return scores;
+}
+
+/*-----------------------------------------------------------------------
+    Estimate betweenness by Brandes' algorithm from random sources.
+
+    Postcondition: Each source's BFS is replayed backwards, passing every
+                   person's dependency on to their predecessors in
+                   proportion to the path counts.
+-----------------------------------------------------------------------*/
+vector<double> BetweennessCentrality::sampledSources(const Options& options) const {
+    int count = nodeCount();
+    int n = (int)lists.people.size();
+    vector<double> scores(count, 0.0);
+    if (n < 3) return scores;
+
+    int samples = options.samples;
+    if (samples <= 0) {
+        double epsilon = options.epsilon;
+        samples = (int)min((double)n, ceil(log(2.0 * n / options.delta) / (2 * epsilon * epsilon)));
+    }
+    bool exact = samples >= n;
+    if (exact) samples = n;
+
+    int threadCount = ParallelChunks::threadsFor(samples, options.threadCount, 1);
+    vector<vector<double>> sums(threadCount, vector<double>(count, 0.0));
+    vector<vector<double>> pathCounts(threadCount, vector<double>(count, 0.0));
+    vector<vector<double>> dependencies(threadCount, vector<double>(count, 0.0));
+    ParallelChunks::run(samples, threadCount, [&](int self, int first, int end) {
+        vector<double>& sum = sums[self];
+        vector<double>& sigma = pathCounts[self];
+        vector<double>& dependency = dependencies[self];
+        for (int sample = first; sample < end; sample++) {
+            int source = exact ? lists.people[sample] : lists.people[SampleRandom(options.seed, sample).below(n)];
+
+            TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(count);
+            vector<int>& queue = ws->queue();
+            ws->visit(source, -1, 0);
+            sigma[source] = 1.0;
+            dependency[source] = 0.0;
+            queue.push_back(source);
+            for (size_t head = 0; head < queue.size(); head++) {
+                int v = queue[head], next = ws->distance(v) + 1;
+                for (int i = lists.offsets[v]; i < lists.offsets[v + 1]; i++) {
+                    int u = lists.targets[i];
+                    if (!ws->visited(u)) {
+                        ws->visit(u, v, next);
+                        sigma[u] = sigma[v];
+                        dependency[u] = 0.0;
+                        queue.push_back(u);
+                    } else if (ws->distance(u) == next) {
+                        sigma[u] += sigma[v];
+                    }
+                }
+            }
+
+            for (size_t i = queue.size(); i-- > 1; ) {
+                int w = queue[i];
+                double share = (1.0 + dependency[w]) / sigma[w];
+                for (int j = lists.offsets[w]; j < lists.offsets[w + 1]; j++) {
+                    int p = lists.targets[j];
+                    if (ws->distance(p) == ws->distance(w) - 1) dependency[p] += sigma[p] * share;
+                }
+                sum[w] += dependency[w];
+            }
+        }
+    });
+
+    double scale = 1.0 / ((double)samples * (n - 1));
+    for (const vector<double>& sum : sums) {
+        for (int id = 0; id < count; id++) {
+            scores[id] += sum[id];
+        }
+    }
+    for (double& score : scores) {
+        score *= scale;
+    }
+    return scores;
+}
+
+/*-----------------------------------------------------------------------
+    Pick the highest scores.
+
+    Postcondition: Returns up to k node IDs, best first.
+-----------------------------------------------------------------------*/
+vector<int> BetweennessCentrality::top(const vector<double>& scores, int k) {
+    vector<int> ids;
+    for (int id = 0; id < (int)scores.size(); id++) {
+        if (scores[id] > 0) ids.push_back(id);
+    }
+    k = max(0, min(k, (int)ids.size()));
+    partial_sort(ids.begin(), ids.begin() + k, ids.end(), [&](int a, int b) {
+        return scores[a] != scores[b] ? scores[a] > scores[b] : a < b;
+    });
+    ids.resize(k);
+    return ids;
+}
+
+/*-----------------------------------------------------------------------
+    Bound the number of people on any shortest path.
+
+    Postcondition: Returns 2e + 1 for the largest reach e of a BFS from
+                   the first person of each connected component.
+-----------------------------------------------------------------------*/
+int BetweennessCentrality::vertexDiameterBound() const {
+    TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(nodeCount());
+    vector<int>& queue = ws->queue();
+    int reach = 0;
+    for (int start : lists.people) {
+        if (ws->visited(start)) continue;
+        queue.clear();
+        ws->visit(start, -1, 0);
+        queue.push_back(start);
+        for (size_t head = 0; head < queue.size(); head++) {
+            int v = queue[head];
+            for (int i = lists.offsets[v]; i < lists.offsets[v + 1]; i++) {
+                if (!ws->visited(lists.targets[i])) {
+                    ws->visit(lists.targets[i], v, ws->distance(v) + 1);
+                    queue.push_back(lists.targets[i]);
+                }
+            }
+        }
+        reach = max(reach, ws->distance(queue.back()));
+    }
+    return 2 * reach + 1;
+}
@@ -0,0 +1,122 @@
+/******************************************************************************
+ * Class: BetweennessCentrality
+ *
+ * Description: Estimates how often each person lies on shortest paths
+ *              between other people, which singles out the "bridges"
+ *              between communities. Exact betweenness needs one BFS per
+ *              person; both estimators here take a sample instead:
+ *
+ *              - approximate() (Riondato-Kornaropoulos): each sample is a
+ *                random pair of people and one of their shortest paths,
+ *                drawn uniformly with the path counts of a BFS; every
+ *                person inside the path gets a point. The number of
+ *                samples follows from the error bound and a bound on the
+ *                longest shortest path, not from the size of the graph.
+ *              - sampledSources(): Brandes' dependency accumulation from
+ *                random source people, scaled up. Each BFS credits every
+ *                path from its source, so fewer samples are needed in
+ *                practice; with at least as many samples as people it
+ *                runs every source once and is exact.
+ *
+ *              Samples run in parallel. Each thread leases its BFS state
+ *              from the traversal workspace pool, keeps its own path
+ *              counts and dependencies, and adds into its own score array;
+ *              the arrays are summed at the end. Each sample draws from a
+ *              generator seeded by its index, so the samples only depend
+ *              on the seed.
+ *
+ *              Scores are normalized over ordered pairs of people:
+ *              b(v) = sum over s != v != t of sigma_st(v) / sigma_st,
+ *              divided by n(n-1), so they lie between 0 and 1.
+ *
+ *              Pairs are sampled from the people of a FriendLists copy of
+ *              the graph view.
+ *
+ * Member Variables:
+ *    - lists: Friend lists of the graph view, which the sampled paths walk
+ *
+ *****************************************************************************/
+
+#ifndef BETWEENNESSCENTRALITY_H
+#define BETWEENNESSCENTRALITY_H
+
+#include "FriendLists.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class BetweennessCentrality {
+public:
+    /***** Options Struct (controls of one estimate) *****/
+    struct Options {
+        double epsilon = 0.01;          // Allowed error on each score
+        double delta = 0.1;             // Allowed chance of any score missing it
+        int samples = 0;                // Samples to take; 0 derives them from epsilon and delta
+        uint64_t seed = 1;              // Picks the samples
+        int threadCount = 0;            // 0 uses one thread per hardware thread
+    };
+
+    /*** Constructer ***/
+    template <class Graph>
+    explicit BetweennessCentrality(const Graph& graph) : lists(graph) {}
+    /*-------------------------------------------------------------------
+      Prepare to estimate the betweenness of the people of a graph view.
+
+      Postcondition: Every estimate samples paths through the same friend
+                     lists; nothing is sampled yet.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return lists.nodeCount(); }
+    /*-------------------------------------------------------------------
+      Get the size of the node ID space.
+     ------------------------------------------------------------------*/
+
+    /*** Estimates **/
+    vector<double> approximate() const { return approximate(Options()); }
+    vector<double> approximate(const Options& options) const;
+    /*-------------------------------------------------------------------
+      Estimate betweenness by sampling shortest paths.
+
+      Postcondition: Element id is the estimated score of node ID id (0
+                     for removed IDs). Without a sample count, takes
+                     (1 / 2eps^2)(floor(log2(VD - 2)) + 1 + ln(1 / delta))
+                     samples, VD bounding the people on any shortest path,
+                     so that every score is within epsilon with probability
+                     at least 1 - delta.
+     ------------------------------------------------------------------*/
+
+    vector<double> sampledSources() const { return sampledSources(Options()); }
+    vector<double> sampledSources(const Options& options) const;
+    /*-------------------------------------------------------------------
+      Estimate betweenness by Brandes' algorithm from random sources.
+
+      Postcondition: Same scores as approximate(). Without a sample count,
+                     takes ln(2n / delta) / (2eps^2) sources for n people,
+                     which holds every score within epsilon with
+                     probability at least 1 - delta. Exact when the count
+                     reaches n.
+     ------------------------------------------------------------------*/
+
+    static vector<int> top(const vector<double>& scores, int k);
+    /*-------------------------------------------------------------------
+      Pick the highest scores.
+
+      Postcondition: Returns up to k node IDs with a score above 0, best
+                     first, ties by lower node ID.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    FriendLists lists;              // Copy of the graph view
+
+    /***** Helper Functions *****/
+    int vertexDiameterBound() const;
+    /*-----------------------------------------------------------------------
+      Bound the number of people on any shortest path by twice the reach
+      of one BFS per connected component, plus one.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
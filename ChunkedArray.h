@@ -0,0 +1,232 @@
+/******************************************************************************
+ * Class: ChunkedArray
+ *
+ * Description: Growable array with cheap copies, stored as chunks of 64
+ *              elements that copies share. Every chunk but the last is full
+ *              and hangs off a PersistentArray; the last one, the tail, is
+ *              held directly, so an array of up to 64 elements is a single
+ *              small chunk. Copying the array copies two pointers, and
+ *              changing, adding or removing an element copies one chunk
+ *              plus the O(log32 n) path to it, never the whole array.
+ *
+ *              Writers pass an edit token, as with PersistentArray: chunks
+ *              created under the current token are changed in place, all
+ *              others are copied first. A token must never be reused once
+ *              a copy of the array has been handed to readers.
+ *
+ * Member Variables:
+ *    - chunks: Full chunks, in order
+ *    - tail: Last chunk, holding 1 to 64 elements (null while empty)
+ *    - tailItems: Elements of tail, read without going through the chunk
+ *    - count: Number of elements
+ *
+ *****************************************************************************/
+
+#ifndef CHUNKEDARRAY_H
+#define CHUNKEDARRAY_H
+
+#include "PersistentArray.h"
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+template <class T>
+class ChunkedArray {
+    /***** Chunk (up to 64 elements, shared by copies) *****/
+    struct Chunk {
+        uint64_t owner = 0;             // Token that may edit in place
+        vector<T> items;                // Full, except in the tail
+    };
+
+public:
+    /***** Iterator Class (walks the array chunk by chunk) *****/
+    class Iterator {
+        const T* at = nullptr;              // Null once past the end
+        const T* stop = nullptr;            // End of the current chunk
+        const ChunkedArray* array = nullptr;
+        int next = 0;                       // Chunk to read after this one
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        Iterator() {}
+        explicit Iterator(const ChunkedArray* array) : array(array) { load(); }
+        /*-------------------------------------------------------------------
+          Construct an iterator at the end, or at the start of array.
+         ------------------------------------------------------------------*/
+
+        const T& operator*() const { return *at; }
+        Iterator& operator++() {
+            if (++at == stop) load();
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const Iterator& other) const { return at == other.at; }
+        bool operator!=(const Iterator& other) const { return at != other.at; }
+        /*-------------------------------------------------------------------
+          Read the element, step to the next one, or compare positions.
+
+          Precondition:  The array is alive and unchanged.
+          Postcondition: Elements are read in place, in index order.
+         ------------------------------------------------------------------*/
+
+    private:
+        void load() {
+            int first = next * Width;
+            if (first >= array->count) {
+                at = nullptr;
+                return;
+            }
+            int length = array->count - first;
+            at = array->items(next++);
+            stop = at + (length < Width ? length : Width);
+        }
+        /*-------------------------------------------------------------------
+          Move on to the first element of the next chunk, or past the end.
+         ------------------------------------------------------------------*/
+    };
+
+    /*** Constructer ***/
+    ChunkedArray() : tailItems(nullptr), count(0) {}
+    /*-------------------------------------------------------------------
+      Construct an empty array.
+
+      Postcondition: size() is 0.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    /*-------------------------------------------------------------------
+      Get the number of elements.
+     ------------------------------------------------------------------*/
+
+    const T& operator[](int i) const { return items(i >> Bits)[i & Mask]; }
+    /*-------------------------------------------------------------------
+      Read one element.
+
+      Precondition:  0 <= i < size().
+      Postcondition: Returns the element in O(log32 n).
+     ------------------------------------------------------------------*/
+
+    Iterator begin() const { return count == 0 ? Iterator() : Iterator(this); }
+    Iterator end() const { return Iterator(); }
+    /*-------------------------------------------------------------------
+      Iterate over the elements in index order.
+
+      Postcondition: Each chunk is looked up once; the elements inside it
+                     are read as a plain array.
+     ------------------------------------------------------------------*/
+
+    /*** Setters **/
+    void assign(int i, T value, uint64_t token) {
+        int c = i >> Bits;
+        if (c == chunks.size()) {
+            editTail(token)[i & Mask] = move(value);
+            return;
+        }
+        if (chunks[c]->owner == token) {
+            const_cast<Chunk&>(*chunks[c]).items[i & Mask] = move(value);
+            return;
+        }
+        shared_ptr<Chunk> copy = make_shared<Chunk>(*chunks[c]);
+        copy->owner = token;
+        copy->items[i & Mask] = move(value);
+        chunks.assign(c, copy, token);
+    }
+    /*-------------------------------------------------------------------
+      Replace one element.
+
+      Precondition:  0 <= i < size(); token identifies the current writer.
+      Postcondition: Element i is value. Copies of this array made before
+                     the call, under another token, are unaffected.
+     ------------------------------------------------------------------*/
+
+    void append(T value, uint64_t token) {
+        // A full tail joins the other full chunks
+        if (tail && (int)tail->items.size() == Width) {
+            chunks.append(tail, token);
+            tail = nullptr;
+        }
+        editTail(token).push_back(move(value));
+        tailItems = tail->items.data();
+        count++;
+    }
+    /*-------------------------------------------------------------------
+      Add an element at the end.
+
+      Precondition:  token identifies the current writer.
+      Postcondition: size() grows by one and the last element is value.
+     ------------------------------------------------------------------*/
+
+    void removeLast(uint64_t token) {
+        count--;
+        if (tail->items.size() > 1) {
+            editTail(token).pop_back();
+            return;
+        }
+        // The last full chunk, if any, becomes the tail
+        tail = nullptr;
+        if (chunks.size() > 0) {
+            tail = chunks[chunks.size() - 1];
+            chunks.removeLast(token);
+        }
+        tailItems = tail ? tail->items.data() : nullptr;
+    }
+    /*-------------------------------------------------------------------
+      Drop the last element.
+
+      Precondition:  size() > 0; token identifies the current writer.
+      Postcondition: size() shrinks by one; the other elements keep their
+                     indexes.
+     ------------------------------------------------------------------*/
+
+private:
+    static const int Bits = 6;
+    static const int Width = 1 << Bits;
+    static const int Mask = Width - 1;
+
+    /***** Data Members *****/
+    PersistentArray<shared_ptr<const Chunk>> chunks;    // Full chunks
+    shared_ptr<const Chunk> tail;                       // Partly or just filled chunk
+    const T* tailItems;                                 // tail->items.data()
+    int count;                                          // Number of elements
+
+    /***** Helper Functions *****/
+    const T* items(int c) const { return c == chunks.size() ? tailItems : chunks[c]->items.data(); }
+    /*-----------------------------------------------------------------------
+      Get the elements of chunk c, which is the tail if every full chunk
+      comes before it.
+     ----------------------------------------------------------------------*/
+
+    vector<T>& editTail(uint64_t token) {
+        if (!tail || tail->owner != token) {
+            shared_ptr<Chunk> copy = tail ? make_shared<Chunk>(*tail) : make_shared<Chunk>();
+            copy->owner = token;
+            tail = copy;
+        }
+        // Created by this writer and not yet visible to any reader
+        vector<T>& items = const_cast<Chunk&>(*tail).items;
+        tailItems = items.data();
+        return items;
+    }
+    /*-----------------------------------------------------------------------
+      Get the elements of the tail for writing, starting a tail if the
+      array has none.
+
+      Postcondition: Returns the elements of a tail owned by token.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
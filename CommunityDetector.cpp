@@ -0,0 +1,399 @@
+/*-------------------------------------------------------------------------
+  CommunityDetector.cpp
+
+  - Implementation of the non-template functions mentioned in CommunityDetector.h
+------------------------------------------------------------------------*/
+#include "CommunityDetector.h"
+#include "ParallelChunks.h"
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+using namespace std;
+
+namespace {
+    /*-----------------------------------------------------------------------
+        Mix the bits of a 64-bit value (splitmix64 finalizer).
+    -----------------------------------------------------------------------*/
+    uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    /*-----------------------------------------------------------------------
+        Pick the half of a round a person decides in.
+    -----------------------------------------------------------------------*/
+    int halfOf(int id, uint64_t seed, int round) {
+        return (int)(mix(seed ^ ((uint64_t)round << 32) ^ (uint32_t)id) & 1);
+    }
+
+    /***** Scratch Map (one thread's group -> weight tally) *****/
+    // Open addressing with linear probing. Only the slots used since the
+    // last clear() are reset, so one map serves every person of a thread.
+    struct ScratchMap {
+        vector<int> keys;           // -1 marks a free slot
+        vector<double> values;
+        vector<int> used;           // Slots filled, in insertion order
+
+        void reserve(int entries) {
+            size_t capacity = 16;
+            while (capacity < 2 * (size_t)entries) capacity *= 2;
+            if (keys.size() < capacity) {
+                clear();
+                keys.assign(capacity, -1);
+                values.assign(capacity, 0.0);
+            }
+        }
+
+        double& operator[](int key) {
+            size_t mask = keys.size() - 1;
+            size_t slot = mix((uint64_t)key) & mask;
+            while (keys[slot] != -1 && keys[slot] != key) {
+                slot = (slot + 1) & mask;
+            }
+            if (keys[slot] == -1) {
+                keys[slot] = key;
+                values[slot] = 0.0;
+                used.push_back((int)slot);
+            }
+            return values[slot];
+        }
+
+        double find(int key) const {
+            size_t mask = keys.size() - 1;
+            for (size_t slot = mix((uint64_t)key) & mask; keys[slot] != -1; slot = (slot + 1) & mask) {
+                if (keys[slot] == key) return values[slot];
+            }
+            return 0.0;
+        }
+
+        void clear() {
+            for (int slot : used) {
+                keys[slot] = -1;
+            }
+            used.clear();
+        }
+    };
+
+    /***** Weighted Graph (one level of Louvain) *****/
+    struct WeightedGraph {
+        vector<int> offsets;        // Start of each node's edges
+        vector<int> targets;        // Neighbor of each edge
+        vector<double> weights;     // Weight of each edge
+        vector<double> loops;       // Weight inside each node, counted from both ends
+
+        int size() const { return (int)offsets.size() - 1; }
+    };
+
+    /*-----------------------------------------------------------------------
+        Move nodes of one Louvain level between communities.
+
+        Postcondition: Returns the community of each node and sets moved
+                      if any node changed community.
+    -----------------------------------------------------------------------*/
+    vector<int> moveNodes(const WeightedGraph& graph, double twoM, const CommunityDetector::Options& options,
+                          int threadCount, vector<ScratchMap>& maps, bool& moved) {
+        int n = graph.size();
+        vector<double> degree(n);
+        for (int v = 0; v < n; v++) {
+            degree[v] = graph.loops[v];
+            for (int i = graph.offsets[v]; i < graph.offsets[v + 1]; i++) {
+                degree[v] += graph.weights[i];
+            }
+        }
+        vector<int> community(n), next(n);
+        vector<double> total(degree);
+        for (int v = 0; v < n; v++) {
+            community[v] = next[v] = v;
+        }
+
+        moved = false;
+        for (int round = 0; round < options.maxIterations; round++) {
+            int moves = 0;
+            for (int half = 0; half < 2; half++) {
+                ParallelChunks::run(n, threadCount, [&](int self, int start, int end) {
+                    ScratchMap& links = maps[self];
+                    for (int v = start; v < end; v++) {
+                        if (halfOf(v, options.seed, round) != half) continue;
+                        links.reserve(graph.offsets[v + 1] - graph.offsets[v]);
+                        for (int i = graph.offsets[v]; i < graph.offsets[v + 1]; i++) {
+                            links[community[graph.targets[i]]] += graph.weights[i];
+                        }
+
+                        // Gain of joining each community, with v taken out
+                        // of its own first
+                        int own = community[v];
+                        double k = degree[v];
+                        double bestGain = links.find(own) - (total[own] - k) * k / twoM;
+                        int choice = own;
+                        for (int slot : links.used) {
+                            int candidate = links.keys[slot];
+                            if (candidate == own) continue;
+                            double gain = links.values[slot] - total[candidate] * k / twoM;
+                            if (gain > bestGain) {
+                                bestGain = gain;
+                                choice = candidate;
+                            }
+                        }
+                        next[v] = choice;
+                        links.clear();
+                    }
+                });
+
+                // Apply the half's moves; the totals change with them
+                for (int v = 0; v < n; v++) {
+                    if (halfOf(v, options.seed, round) != half || next[v] == community[v]) continue;
+                    total[community[v]] -= degree[v];
+                    total[next[v]] += degree[v];
+                    community[v] = next[v];
+                    moves++;
+                }
+            }
+            if (moves == 0) break;
+            moved = true;
+        }
+        return community;
+    }
+
+    /*-----------------------------------------------------------------------
+        Score the communities of one Louvain level.
+    -----------------------------------------------------------------------*/
+    double levelModularity(const WeightedGraph& graph, const vector<int>& community, int communityCount, double twoM) {
+        vector<double> inside(communityCount, 0.0), total(communityCount, 0.0);
+        for (int v = 0; v < graph.size(); v++) {
+            int c = community[v];
+            inside[c] += graph.loops[v];
+            total[c] += graph.loops[v];
+            for (int i = graph.offsets[v]; i < graph.offsets[v + 1]; i++) {
+                total[c] += graph.weights[i];
+                if (community[graph.targets[i]] == c) inside[c] += graph.weights[i];
+            }
+        }
+        double quality = 0.0;
+        for (int c = 0; c < communityCount; c++) {
+            quality += inside[c] / twoM - (total[c] / twoM) * (total[c] / twoM);
+        }
+        return quality;
+    }
+
+    /*-----------------------------------------------------------------------
+        Collapse each community of a level into one node.
+
+        Precondition:  community holds IDs in [0, communityCount).
+        Postcondition: Returns the next level; edges between two
+                      communities are summed into one.
+    -----------------------------------------------------------------------*/
+    WeightedGraph collapse(const WeightedGraph& graph, const vector<int>& community, int communityCount,
+                           int threadCount, vector<ScratchMap>& maps) {
+        // Members of each community, by counting sort
+        vector<int> memberOffsets(communityCount + 1, 0), members(graph.size());
+        for (int v = 0; v < graph.size(); v++) {
+            memberOffsets[community[v] + 1]++;
+        }
+        for (int c = 0; c < communityCount; c++) {
+            memberOffsets[c + 1] += memberOffsets[c];
+        }
+        vector<int> fill(memberOffsets.begin(), memberOffsets.end() - 1);
+        for (int v = 0; v < graph.size(); v++) {
+            members[fill[community[v]]++] = v;
+        }
+
+        WeightedGraph coarse;
+        coarse.loops.assign(communityCount, 0.0);
+        vector<vector<pair<int, double>>> rows(communityCount);
+        ParallelChunks::run(communityCount, threadCount, [&](int self, int start, int end) {
+            ScratchMap& links = maps[self];
+            for (int c = start; c < end; c++) {
+                int edges = 0;
+                for (int m = memberOffsets[c]; m < memberOffsets[c + 1]; m++) {
+                    edges += graph.offsets[members[m] + 1] - graph.offsets[members[m]];
+                }
+                links.reserve(edges);
+                for (int m = memberOffsets[c]; m < memberOffsets[c + 1]; m++) {
+                    int v = members[m];
+                    coarse.loops[c] += graph.loops[v];
+                    for (int i = graph.offsets[v]; i < graph.offsets[v + 1]; i++) {
+                        int target = community[graph.targets[i]];
+                        if (target == c) coarse.loops[c] += graph.weights[i];
+                        else links[target] += graph.weights[i];
+                    }
+                }
+                for (int slot : links.used) {
+                    rows[c].emplace_back(links.keys[slot], links.values[slot]);
+                }
+                links.clear();
+            }
+        });
+
+        coarse.offsets.reserve(communityCount + 1);
+        coarse.offsets.push_back(0);
+        for (const vector<pair<int, double>>& row : rows) {
+            for (const pair<int, double>& edge : row) {
+                coarse.targets.push_back(edge.first);
+                coarse.weights.push_back(edge.second);
+            }
+            coarse.offsets.push_back((int)coarse.targets.size());
+        }
+        return coarse;
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Find communities by label propagation.
+
+    Postcondition: Returns the community of each node ID, -1 for removed
+                  IDs.
+-----------------------------------------------------------------------*/
+vector<int> CommunityDetector::labelPropagation(const Options& options) const {
+    int count = nodeCount();
+    vector<int> labels(count), next(count);
+    for (int id = 0; id < count; id++) {
+        labels[id] = next[id] = lists.isPerson(id) ? id : -1;
+    }
+
+    int threadCount = ParallelChunks::threadsFor(count, options.threadCount);
+    vector<ScratchMap> maps(threadCount);
+    for (int round = 0; round < options.maxIterations; round++) {
+        atomic<int> changes(0);
+        for (int half = 0; half < 2; half++) {
+            ParallelChunks::run(count, threadCount, [&](int self, int start, int end) {
+                ScratchMap& votes = maps[self];
+                int changed = 0;
+                for (int v = start; v < end; v++) {
+                    if (!lists.isPerson(v) || lists.degree(v) == 0 || halfOf(v, options.seed, round) != half) continue;
+                    votes.reserve(lists.degree(v));
+                    for (int i = lists.offsets[v]; i < lists.offsets[v + 1]; i++) {
+                        votes[labels[lists.targets[i]]] += 1.0;
+                    }
+
+                    // Keep the current label while it is among the most
+                    // common; other ties go to the lowest seeded hash
+                    int current = labels[v];
+                    int choice = current;
+                    double best = votes.find(current);
+                    for (int slot : votes.used) {
+                        int label = votes.keys[slot];
+                        double weight = votes.values[slot];
+                        if (weight > best) {
+                            best = weight;
+                            choice = label;
+                        }
+                        else if (weight == best && choice != current &&
+                                 mix(options.seed ^ (uint32_t)label) < mix(options.seed ^ (uint32_t)choice)) {
+                            choice = label;
+                        }
+                    }
+                    next[v] = choice;
+                    if (choice != current) changed++;
+                    votes.clear();
+                }
+                changes.fetch_add(changed, memory_order_relaxed);
+            });
+
+            ParallelChunks::run(count, threadCount, [&](int, int start, int end) {
+                for (int v = start; v < end; v++) {
+                    if (halfOf(v, options.seed, round) == half) labels[v] = next[v];
+                }
+            });
+        }
+        if (changes.load() == 0) break;
+    }
+    return numbered(labels);
+}
+
+/*-----------------------------------------------------------------------
+    Find communities by multi-level modularity optimization.
+
+    Postcondition: Returns the community of each node ID, -1 for removed
+                  IDs.
+-----------------------------------------------------------------------*/
+vector<int> CommunityDetector::louvain(const Options& options) const {
+    int count = nodeCount();
+    vector<int> assignment(count);
+    for (int id = 0; id < count; id++) {
+        assignment[id] = id;
+    }
+    double twoM = (double)lists.targets.size();
+    if (twoM == 0.0) return numbered(assignment);
+
+    WeightedGraph level;
+    level.offsets = lists.offsets;
+    level.targets = lists.targets;
+    level.weights.assign(lists.targets.size(), 1.0);
+    level.loops.assign(count, 0.0);
+
+    int threadCount = ParallelChunks::threadsFor(count, options.threadCount);
+    vector<ScratchMap> maps(threadCount);
+    vector<int> singletons(assignment);
+    double quality = levelModularity(level, singletons, count, twoM);
+    while (true) {
+        bool moved = false;
+        vector<int> community = moveNodes(level, twoM, options, threadCount, maps, moved);
+        if (!moved) break;
+
+        // Number the surviving communities and carry the people along
+        vector<int> compact(level.size(), -1);
+        int communityCount = 0;
+        for (int v = 0; v < level.size(); v++) {
+            if (compact[community[v]] == -1) compact[community[v]] = communityCount++;
+            community[v] = compact[community[v]];
+        }
+        for (int id = 0; id < count; id++) {
+            assignment[id] = community[assignment[id]];
+        }
+
+        double gained = levelModularity(level, community, communityCount, twoM) - quality;
+        quality += gained;
+        level = collapse(level, community, communityCount, threadCount, maps);
+        if (gained < options.tolerance) break;
+    }
+    return numbered(assignment);
+}
+
+/*-----------------------------------------------------------------------
+    Score a split of the network.
+
+    Postcondition: Returns the modularity, 0 without friendships.
+-----------------------------------------------------------------------*/
+double CommunityDetector::modularity(const vector<int>& communities) const {
+    double twoM = (double)lists.targets.size();
+    if (twoM == 0.0) return 0.0;
+
+    int communityCount = 0;
+    for (int id = 0; id < nodeCount(); id++) {
+        if (lists.isPerson(id)) communityCount = max(communityCount, communities[id] + 1);
+    }
+    vector<double> inside(communityCount, 0.0), total(communityCount, 0.0);
+    for (int v = 0; v < nodeCount(); v++) {
+        if (!lists.isPerson(v)) continue;
+        int c = communities[v];
+        total[c] += lists.degree(v);
+        for (int i = lists.offsets[v]; i < lists.offsets[v + 1]; i++) {
+            if (communities[lists.targets[i]] == c) inside[c] += 1.0;
+        }
+    }
+    double quality = 0.0;
+    for (int c = 0; c < communityCount; c++) {
+        quality += inside[c] / twoM - (total[c] / twoM) * (total[c] / twoM);
+    }
+    return quality;
+}
+
+/*-----------------------------------------------------------------------
+    Renumber labels from 0 in order of first appearance.
+
+    Precondition:  Labels of living people are in [0, nodeCount()).
+    Postcondition: Removed IDs get -1.
+-----------------------------------------------------------------------*/
+vector<int> CommunityDetector::numbered(const vector<int>& labels) const {
+    vector<int> renumber(nodeCount(), -1), communities(nodeCount(), -1);
+    int next = 0;
+    for (int id = 0; id < nodeCount(); id++) {
+        if (!lists.isPerson(id)) continue;
+        if (renumber[labels[id]] == -1) renumber[labels[id]] = next++;
+        communities[id] = renumber[labels[id]];
+    }
+    return communities;
+}
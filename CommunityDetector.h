@@ -0,0 +1,113 @@
+/******************************************************************************
+ * Class: CommunityDetector
+ *
+ * Description: Splits the network into friend groups. Two methods share one
+ *              copy of the friend lists in compressed sparse row form:
+ *
+ *              - Label propagation: everyone starts in a group of their own
+ *                and repeatedly joins the group most of their friends are
+ *                in. Fast, but the groups are only as good as a few rounds
+ *                of voting make them.
+ *              - Louvain: people move to whichever neighboring group raises
+ *                the modularity of the split the most; once nobody moves,
+ *                each group is collapsed into one weighted node and the
+ *                process repeats on the smaller graph.
+ *
+ *              Both run in rounds on all cores. In each round a seeded hash
+ *              splits the people into two halves that decide one after the
+ *              other; within a half, every decision reads the state as it
+ *              was when the half started. The result therefore only
+ *              depends on the graph and the seed, never on the number of
+ *              threads or their timing, and neighbors rarely flip back and
+ *              forth in lockstep. Each thread tallies group weights in a
+ *              scratch hash map of its own.
+ *
+ *              Both methods start from a FriendLists copy of the graph
+ *              view, which is also the first level of Louvain.
+ *
+ * Member Variables:
+ *    - lists: Friend lists of the graph view; Louvain's first level
+ *
+ *****************************************************************************/
+
+#ifndef COMMUNITYDETECTOR_H
+#define COMMUNITYDETECTOR_H
+
+#include "FriendLists.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class CommunityDetector {
+public:
+    /***** Options Struct (controls of one run) *****/
+    struct Options {
+        int maxIterations = 20;         // Rounds per run (per level for Louvain)
+        double tolerance = 1e-6;        // Louvain stops once a level gains less modularity
+        uint64_t seed = 1;              // Picks the halves and breaks ties
+        int threadCount = 0;            // 0 uses one thread per hardware thread
+    };
+
+    /*** Constructer ***/
+    template <class Graph>
+    explicit CommunityDetector(const Graph& graph) : lists(graph) {}
+    /*-------------------------------------------------------------------
+      Prepare to find the communities of a graph view.
+
+      Postcondition: Any number of runs, by either method and with any
+                     options, share one copy of the friend lists.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return lists.nodeCount(); }
+    /*-------------------------------------------------------------------
+      Get the size of the node ID space.
+     ------------------------------------------------------------------*/
+
+    /*** Detection **/
+    vector<int> labelPropagation() const { return labelPropagation(Options()); }
+    vector<int> labelPropagation(const Options& options) const;
+    /*-------------------------------------------------------------------
+      Find communities by label propagation.
+
+      Postcondition: Element id is the community of node ID id, numbered
+                     from 0 in order of each community's lowest node ID,
+                     or -1 for removed IDs. Stops when a round changes
+                     nothing or after maxIterations rounds.
+     ------------------------------------------------------------------*/
+
+    vector<int> louvain() const { return louvain(Options()); }
+    vector<int> louvain(const Options& options) const;
+    /*-------------------------------------------------------------------
+      Find communities by multi-level modularity optimization.
+
+      Postcondition: Same numbering as labelPropagation(). Stops when a
+                     level merges nothing or gains less than tolerance.
+     ------------------------------------------------------------------*/
+
+    double modularity(const vector<int>& communities) const;
+    /*-------------------------------------------------------------------
+      Score a split of the network.
+
+      Precondition:  communities has one entry per node ID; entries of
+                     removed IDs are ignored.
+      Postcondition: Returns the modularity, between -0.5 and 1; higher
+                     means more friendships inside the communities than
+                     chance would give. Returns 0 without friendships.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    FriendLists lists;              // Copy of the graph view
+
+    /***** Helper Functions *****/
+    vector<int> numbered(const vector<int>& labels) const;
+    /*-----------------------------------------------------------------------
+      Renumber labels from 0 in order of first appearance.
+
+      Postcondition: Removed IDs get -1.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
@@ -0,0 +1,92 @@
+/*-------------------------------------------------------------------------
+  CoreIndex.cpp
+
+  - Implementation of the non-template functions mentioned in CoreIndex.h
+------------------------------------------------------------------------*/
+#include "CoreIndex.h"
+
+using namespace std;
+
+/*-----------------------------------------------------------------------
+    Get the largest core number.
+
+    Postcondition: Returns 0 for an empty graph.
+-----------------------------------------------------------------------*/
+int CoreIndex::maxCore() const {
+    for (int core = (int)heads.size() - 1; core > 0; core--) {
+        if (heads[core] != -1) return core;
+    }
+    return 0;
+}
+
+/*-----------------------------------------------------------------------
+    Cover node IDs added to the graph since the index last saw it.
+
+    Postcondition: New node IDs have core 0 and sit at the end of its list.
+-----------------------------------------------------------------------*/
+void CoreIndex::grow(int count) {
+    int old = nodeCount();
+    if (count <= old) return;
+    cores.resize(count, 0);
+    laterFriends.resize(count, 0);
+    nexts.resize(count, -1);
+    prevs.resize(count, -1);
+    labels.resize(count, 0);
+    for (int id = old; id < count; id++) {
+        link(id, 0, heads.empty() ? -1 : tails[0]);
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Insert a node ID into the list of a core.
+
+    Precondition:  prev is in that list, or -1 for the front.
+    Postcondition: id follows prev and has a label between its neighbors'.
+                   Appending leaves a full gap behind, so people moved to
+                   the end one after another rarely force a relabel.
+-----------------------------------------------------------------------*/
+void CoreIndex::link(int id, int core, int prev) {
+    if ((int)heads.size() <= core) {
+        heads.resize(core + 1, -1);
+        tails.resize(core + 1, -1);
+    }
+    int next = prev == -1 ? heads[core] : nexts[prev];
+    prevs[id] = prev;
+    nexts[id] = next;
+    if (prev == -1) heads[core] = id;
+    else nexts[prev] = id;
+    if (next == -1) tails[core] = id;
+    else prevs[next] = id;
+
+    uint64_t low = prev == -1 ? 0 : labels[prev];
+    uint64_t high = next == -1 ? UINT64_MAX : labels[next];
+    if (next == -1 && high - low > Spacing) labels[id] = low + Spacing;
+    else if (high - low >= 2) labels[id] = low + (high - low) / 2;
+    else relabel(core);
+}
+
+/*-----------------------------------------------------------------------
+    Take a node ID out of the list of a core.
+
+    Postcondition: The neighbors of id are linked to each other.
+-----------------------------------------------------------------------*/
+void CoreIndex::unlink(int id, int core) {
+    if (prevs[id] == -1) heads[core] = nexts[id];
+    else nexts[prevs[id]] = nexts[id];
+    if (nexts[id] == -1) tails[core] = prevs[id];
+    else prevs[nexts[id]] = prevs[id];
+    prevs[id] = nexts[id] = -1;
+}
+
+/*-----------------------------------------------------------------------
+    Spread the labels of a core evenly.
+
+    Postcondition: Labels keep their order and are Spacing apart.
+-----------------------------------------------------------------------*/
+void CoreIndex::relabel(int core) {
+    uint64_t label = Spacing;
+    for (int id = heads[core]; id != -1; id = nexts[id]) {
+        labels[id] = label;
+        label += Spacing;
+    }
+}
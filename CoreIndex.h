@@ -0,0 +1,467 @@
+/******************************************************************************
+ * Class: CoreIndex
+ *
+ * Description: Core number of every person: the largest k such that the
+ *              person belongs to a group in which everyone has at least k
+ *              friends inside the group. Dense rings of accounts that all
+ *              befriend each other stand out with unusually high cores.
+ *
+ *              peel() is the linear-time bucket algorithm of Batagelj and
+ *              Zaversnik: people are kept in buckets by remaining degree
+ *              and removed lowest first. peelParallel() computes the same
+ *              numbers as the fixed point of "core = h-index of the friends'
+ *              cores", refining all people on all cores until nothing
+ *              changes; only people whose friends changed are looked at
+ *              again.
+ *
+ *              A CoreIndex keeps the numbers up to date as friendships are
+ *              made or broken. Besides the cores it keeps an order in which
+ *              peeling could have removed everyone, stored as one linked
+ *              list per core with order labels for quick comparison, and
+ *              for each person the number of friends later in that order
+ *              (never more than their core). A new friendship only matters
+ *              if it pushes the earlier person over their core; then only
+ *              people of that core further down the order whose counts
+ *              change are looked at. A broken friendship lowers cores by
+ *              at most one, spreading only through people who drop.
+ *
+ *              Works on any graph view offering nodeCount() and
+ *              neighbors(id) (SocialGraph::Snapshot and GraphSnapshot).
+ *
+ * Member Variables:
+ *    - cores: Core number of each node ID
+ *    - laterFriends: Friends later in the peeling order, per node ID
+ *    - nexts, prevs: Neighbors in the peeling order within the same core
+ *    - labels: Increasing order labels within each core
+ *    - heads, tails: First and last node ID of each core, -1 if none
+ *
+ *****************************************************************************/
+
+#ifndef COREINDEX_H
+#define COREINDEX_H
+
+#include "ParallelChunks.h"
+#include "TraversalWorkspace.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class CoreIndex {
+public:
+    /*** Constructer ***/
+    template <class Graph>
+    explicit CoreIndex(const Graph& graph) {
+        recompute(graph);
+    }
+    /*-------------------------------------------------------------------
+      Compute the core numbers of a graph.
+
+      Postcondition: Costs one peel().
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return (int)cores.size(); }
+    int coreNumber(int id) const { return cores[id]; }
+    const vector<int>& getCores() const { return cores; }
+    int maxCore() const;
+    /*-------------------------------------------------------------------
+      Get the core number of one node ID, of all of them, or the largest.
+
+      Precondition:  id is below nodeCount().
+     ------------------------------------------------------------------*/
+
+    /*** Maintenance **/
+    template <class Graph>
+    void friendAdded(const Graph& graph, int a, int b);
+    template <class Graph>
+    void friendRemoved(const Graph& graph, int a, int b);
+    /*-------------------------------------------------------------------
+      Update the core numbers after one friendship was made or broken.
+
+      Precondition:  graph holds the change, and apart from it matches
+                     what the index has seen; the friendship really was
+                     new or really did exist. Node IDs new to the index
+                     start without friends.
+      Postcondition: The core numbers match graph.
+     ------------------------------------------------------------------*/
+
+    template <class Graph>
+    void recompute(const Graph& graph);
+    /*-------------------------------------------------------------------
+      Recompute every core number.
+
+      Postcondition: The core numbers match graph. Use after removing
+                     people or applying a batch without updating the
+                     index change by change.
+     ------------------------------------------------------------------*/
+
+    /*** Decomposition **/
+    template <class Graph>
+    static vector<int> peel(const Graph& graph) {
+        vector<int> order;
+        return peel(graph, order);
+    }
+    /*-------------------------------------------------------------------
+      Compute core numbers by bucket peeling.
+
+      Postcondition: Element id is the core number of node ID id. Costs
+                     O(V + E) on one thread.
+     ------------------------------------------------------------------*/
+
+    template <class Graph>
+    static vector<int> peelParallel(const Graph& graph, int threadCount = 0);
+    /*-------------------------------------------------------------------
+      Compute core numbers by parallel h-index refinement.
+
+      Precondition:  threadCount of 0 uses one thread per hardware thread.
+      Postcondition: Same result as peel().
+     ------------------------------------------------------------------*/
+
+private:
+    static const uint64_t Spacing = (uint64_t)1 << 32;     // Gap between fresh labels
+
+    /***** Data Members *****/
+    vector<int> cores;              // Core number of each node ID
+    vector<int> laterFriends;       // Friends later in the order
+    vector<int> nexts, prevs;       // Order links, -1 at the ends
+    vector<uint64_t> labels;        // Order labels
+    vector<int> heads, tails;       // Ends of each core's list
+
+    /***** Helper Functions *****/
+    template <class Graph>
+    static vector<int> peel(const Graph& graph, vector<int>& order);
+    /*-----------------------------------------------------------------------
+      Bucket peeling that also returns the order people were removed in.
+     ----------------------------------------------------------------------*/
+
+    bool before(int a, int b) const {
+        return cores[a] != cores[b] ? cores[a] < cores[b] : labels[a] < labels[b];
+    }
+    /*-----------------------------------------------------------------------
+      Check whether a comes before b in the peeling order.
+     ----------------------------------------------------------------------*/
+
+    void grow(int count);
+    void link(int id, int core, int prev);
+    void unlink(int id, int core);
+    void relabel(int core);
+    /*-----------------------------------------------------------------------
+      Append new node IDs to core 0; insert id into the list of core after
+      prev (at the front for -1) or take it out; spread the labels of a
+      core evenly once two neighbors have no label left between them.
+     ----------------------------------------------------------------------*/
+};
+
+/*-----------------------------------------------------------------------
+    Recompute every core number and the peeling order.
+
+    Postcondition: The lists follow the order peel() removed people in.
+-----------------------------------------------------------------------*/
+template <class Graph>
+void CoreIndex::recompute(const Graph& graph) {
+    vector<int> order;
+    cores = peel(graph, order);
+    int count = nodeCount();
+    laterFriends.assign(count, 0);
+    nexts.assign(count, -1);
+    prevs.assign(count, -1);
+    labels.assign(count, 0);
+    heads.clear();
+    tails.clear();
+    for (int id : order) {
+        link(id, cores[id], cores[id] < (int)tails.size() ? tails[cores[id]] : -1);
+    }
+    for (int id = 0; id < count; id++) {
+        for (int u : graph.neighbors(id)) {
+            if (before(id, u)) laterFriends[id]++;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Compute core numbers by bucket peeling (Batagelj-Zaversnik).
+
+    Postcondition: Returns the core number of every node ID; order holds
+                   the node IDs in the order they were peeled.
+-----------------------------------------------------------------------*/
+template <class Graph>
+vector<int> CoreIndex::peel(const Graph& graph, vector<int>& order) {
+    int count = graph.nodeCount();
+    vector<int> degree(count);
+    int maxDegree = 0;
+    for (int id = 0; id < count; id++) {
+        degree[id] = graph.neighbors(id).size();
+        maxDegree = max(maxDegree, degree[id]);
+    }
+
+    // order holds the people sorted by current degree; start[d] is where
+    // degree d begins and position[id] where id sits
+    vector<int> start(maxDegree + 2, 0), position(count);
+    order.assign(count, 0);
+    for (int id = 0; id < count; id++) {
+        start[degree[id] + 1]++;
+    }
+    for (int d = 0; d <= maxDegree; d++) {
+        start[d + 1] += start[d];
+    }
+    vector<int> next(start.begin(), start.end() - 1);
+    for (int id = 0; id < count; id++) {
+        position[id] = next[degree[id]]++;
+        order[position[id]] = id;
+    }
+
+    // Take the lowest remaining degree; each friend still in the graph
+    // with a higher degree moves down one bucket by a swap
+    for (int i = 0; i < count; i++) {
+        int v = order[i];
+        for (int u : graph.neighbors(v)) {
+            if (degree[u] <= degree[v]) continue;
+            int d = degree[u];
+            int first = order[start[d]];
+            if (first != u) {
+                swap(order[position[u]], order[start[d]]);
+                position[first] = position[u];
+                position[u] = start[d];
+            }
+            start[d]++;
+            degree[u]--;
+        }
+    }
+    return degree;
+}
+
+/*-----------------------------------------------------------------------
+    Compute core numbers by parallel h-index refinement.
+
+    Postcondition: Returns the core number of every node ID.
+-----------------------------------------------------------------------*/
+template <class Graph>
+vector<int> CoreIndex::peelParallel(const Graph& graph, int threadCount) {
+    int count = graph.nodeCount();
+    threadCount = ParallelChunks::threadsFor(count, threadCount);
+
+    // Estimates start at the degree and only ever go down, so reading a
+    // friend's estimate while it changes still converges to the cores
+    vector<atomic<int>> estimate(count);
+    vector<atomic<uint8_t>> active(count);
+    int maxDegree = 0;
+    for (int id = 0; id < count; id++) {
+        int degree = graph.neighbors(id).size();
+        estimate[id].store(degree, memory_order_relaxed);
+        active[id].store(1, memory_order_relaxed);
+        maxDegree = max(maxDegree, degree);
+    }
+
+    vector<vector<int>> tallies(threadCount, vector<int>(maxDegree + 1, 0));
+    atomic<bool> changed(true);
+    while (changed.load()) {
+        changed.store(false);
+        ParallelChunks::run(count, threadCount, [&](int self, int first, int end) {
+            vector<int>& tally = tallies[self];
+            bool any = false;
+            for (int v = first; v < end; v++) {
+                if (!active[v].exchange(0, memory_order_relaxed)) continue;
+                int k = estimate[v].load(memory_order_relaxed);
+                if (k == 0) continue;
+
+                // Largest h with at least h friends estimated at h or more
+                for (int u : graph.neighbors(v)) {
+                    tally[min(k, estimate[u].load(memory_order_relaxed))]++;
+                }
+                int h = k, atLeast = 0;
+                for (; h > 0; h--) {
+                    atLeast += tally[h];
+                    if (atLeast >= h) break;
+                }
+                fill(tally.begin(), tally.begin() + k + 1, 0);
+
+                if (h < k) {
+                    estimate[v].store(h, memory_order_relaxed);
+                    any = true;
+                    for (int u : graph.neighbors(v)) {
+                        if (estimate[u].load(memory_order_relaxed) > h) active[u].store(1, memory_order_relaxed);
+                    }
+                }
+            }
+            if (any) changed.store(true);
+        });
+    }
+
+    vector<int> result(count);
+    for (int id = 0; id < count; id++) {
+        result[id] = estimate[id].load(memory_order_relaxed);
+    }
+    return result;
+}
+
+/*-----------------------------------------------------------------------
+    Update the core numbers after a friendship was made.
+
+    Precondition:  graph already holds the friendship.
+    Postcondition: Let a come first in the order, with core k. If a now
+                   has more than k later friends, the people of core k
+                   from a on are scanned in order, skipping anyone not
+                   next to a candidate. A scanned person whose later
+                   friends plus earlier candidate friends exceed k becomes
+                   a candidate and leaves the list; anyone else stays, and
+                   candidates relying on them may drop out and rejoin the
+                   list right there. The candidates left at the end move
+                   to the front of core k + 1.
+-----------------------------------------------------------------------*/
+template <class Graph>
+void CoreIndex::friendAdded(const Graph& graph, int a, int b) {
+    grow(graph.nodeCount());
+    if (a == b) return;
+    if (!before(a, b)) swap(a, b);
+    int k = cores[a];
+    if (++laterFriends[a] <= k) return;
+
+    // Parent slot: Pending while waiting to be scanned, Placed once back
+    // in the list, or the candidate's position among the candidates. The
+    // distance slot counts earlier candidate friends.
+    const int Pending = -2, Placed = -3;
+    TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(nodeCount());
+    vector<int>& candidates = ws->queue();
+    vector<int> pending(1, a), dropouts;
+    auto later = [&](int x, int y) { return labels[x] > labels[y]; };
+    auto support = [&](int id) { return laterFriends[id] + ws->distance(id); };
+    ws->visit(a, Pending, 0);
+
+    while (!pending.empty()) {
+        pop_heap(pending.begin(), pending.end(), later);
+        int w = pending.back();
+        pending.pop_back();
+
+        if (support(w) > k) {
+            for (int u : graph.neighbors(w)) {
+                if (cores[u] != k) continue;
+                if (!ws->visited(u) && labels[u] > labels[w]) {
+                    ws->visit(u, Pending, 1);
+                    pending.push_back(u);
+                    push_heap(pending.begin(), pending.end(), later);
+                } else if (ws->visited(u) && ws->parent(u) == Pending) {
+                    ws->visit(u, Pending, ws->distance(u) + 1);
+                }
+            }
+            ws->visit(w, (int)candidates.size(), ws->distance(w));
+            candidates.push_back(w);
+            unlink(w, k);
+            continue;
+        }
+
+        // w stays; the candidates before it now have it as a fixed later
+        // friend instead of a possible one
+        laterFriends[w] = support(w);
+        ws->visit(w, Placed, 0);
+        int cursor = w;
+        for (int u : graph.neighbors(w)) {
+            if (cores[u] != k || !ws->visited(u) || ws->parent(u) < 0) continue;
+            laterFriends[u]--;
+            if (support(u) <= k) dropouts.push_back(u);
+        }
+        while (!dropouts.empty()) {
+            int c = dropouts.back();
+            dropouts.pop_back();
+            int rank = ws->parent(c);
+            if (rank < 0) continue;
+            laterFriends[c] = support(c);
+            ws->visit(c, Placed, 0);
+            link(c, k, cursor);
+            cursor = c;
+            for (int u : graph.neighbors(c)) {
+                if (cores[u] != k || !ws->visited(u) || ws->parent(u) == Placed) continue;
+                if (ws->parent(u) == Pending || ws->parent(u) > rank) {
+                    ws->visit(u, ws->parent(u), ws->distance(u) - 1);
+                } else {
+                    laterFriends[u]--;
+                }
+                if (ws->parent(u) >= 0 && support(u) <= k) dropouts.push_back(u);
+            }
+        }
+    }
+
+    int prev = -1;
+    for (int c : candidates) {
+        if (ws->parent(c) < 0) continue;
+        cores[c] = k + 1;
+        link(c, k + 1, prev);
+        prev = c;
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Update the core numbers after a friendship was broken.
+
+    Precondition:  graph no longer holds the friendship.
+    Postcondition: Only people with the smaller core k of the two ends can
+                   move down, to k - 1, and only by losing a friend who did.
+                   Starting from a and b, anyone left with fewer than k
+                   friends of core k or more drops, and their friends are
+                   checked in turn. The people who dropped move to the end
+                   of core k - 1 in the order they dropped.
+-----------------------------------------------------------------------*/
+template <class Graph>
+void CoreIndex::friendRemoved(const Graph& graph, int a, int b) {
+    grow(graph.nodeCount());
+    if (a == b) return;
+    if (!before(a, b)) swap(a, b);
+    laterFriends[a]--;
+
+    // Parent slot: 1 once a person drops. A dropped person keeps core k
+    // until their friends are told, so a friend first counted before that
+    // counts them and loses them exactly once.
+    int k = cores[a];
+    TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(nodeCount());
+    vector<int>& dropped = ws->queue();
+    auto support = [&](int id) {
+        int held = 0;
+        for (int u : graph.neighbors(id)) {
+            if (cores[u] >= k) held++;
+        }
+        return held;
+    };
+    auto check = [&](int v, int held) {
+        ws->visit(v, held < k ? 1 : 0, held);
+        if (held < k) dropped.push_back(v);
+    };
+    for (int root : { a, b }) {
+        if (cores[root] == k && !ws->visited(root)) check(root, support(root));
+    }
+    for (size_t head = 0; head < dropped.size(); head++) {
+        int v = dropped[head];
+        cores[v] = k - 1;
+        for (int u : graph.neighbors(v)) {
+            if (cores[u] != k) continue;
+            if (!ws->visited(u)) check(u, support(u));
+            else if (ws->parent(u) == 0) check(u, ws->distance(u) - 1);
+        }
+    }
+
+    // Dropped people count the friends who stayed at k or above and those
+    // who dropped after them; friends of core k who came before them lose
+    // them as later friends. The distance slot becomes the drop position.
+    for (size_t i = 0; i < dropped.size(); i++) {
+        ws->visit(dropped[i], 1, (int)i);
+    }
+    for (size_t i = 0; i < dropped.size(); i++) {
+        int v = dropped[i], later = 0;
+        for (int u : graph.neighbors(v)) {
+            if (cores[u] >= k) {
+                later++;
+                if (cores[u] == k && labels[u] < labels[v]) laterFriends[u]--;
+            } else if (cores[u] == k - 1 && ws->visited(u) && ws->parent(u) == 1 && ws->distance(u) > (int)i) {
+                later++;
+            }
+        }
+        laterFriends[v] = later;
+    }
+    for (int v : dropped) {
+        unlink(v, k);
+        link(v, k - 1, tails[k - 1]);
+    }
+}
+
+#endif
@@ -0,0 +1,219 @@
+/*-------------------------------------------------------------------------
+  DiameterFinder.cpp
+
+  - Implementation of the non-template functions mentioned in DiameterFinder.h
+------------------------------------------------------------------------*/
+#include "DiameterFinder.h"
+#include "ParallelChunks.h"
+#include "TraversalWorkspace.h"
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+namespace {
+    /*-----------------------------------------------------------------------
+        Run a BFS over friend lists.
+
+        Precondition:  ws has not visited source; people visited before
+                       are treated as walls.
+        Postcondition: ws's queue holds everyone reachable from source in
+                       the order reached, so its last element is one of
+                       the people farthest away.
+    -----------------------------------------------------------------------*/
+    void search(const FriendLists& lists, int source, TraversalWorkspace& ws) {
+        vector<int>& queue = ws.queue();
+        queue.clear();
+        ws.visit(source, -1, 0);
+        queue.push_back(source);
+        for (size_t head = 0; head < queue.size(); head++) {
+            int v = queue[head], next = ws.distance(v) + 1;
+            for (int i = lists.offsets[v]; i < lists.offsets[v + 1]; i++) {
+                if (!ws.visited(lists.targets[i])) {
+                    ws.visit(lists.targets[i], v, next);
+                    queue.push_back(lists.targets[i]);
+                }
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Find the exact diameter of every connected component.
+
+    Postcondition: Components are gathered by one BFS each, then solved
+                   one at a time.
+-----------------------------------------------------------------------*/
+vector<DiameterFinder::Component> DiameterFinder::diameters(int threadCount) const {
+    vector<Component> result;
+    TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(nodeCount());
+    vector<int> members;
+    for (int start : lists.people) {
+        if (ws->visited(start)) continue;
+        search(lists, start, *ws);
+        members = ws->queue();
+        result.push_back(sweep(members, threadCount));
+    }
+    sort(result.begin(), result.end(), [](const Component& a, const Component& b) {
+        return a.diameter != b.diameter ? a.diameter > b.diameter : a.from < b.from;
+    });
+    return result;
+}
+
+/*-----------------------------------------------------------------------
+    Find the exact diameter of the network.
+
+    Postcondition: Components come out largest first.
+-----------------------------------------------------------------------*/
+int DiameterFinder::diameter(int threadCount) const {
+    vector<Component> components = diameters(threadCount);
+    return components.empty() ? 0 : components[0].diameter;
+}
+
+/*-----------------------------------------------------------------------
+    Find the exact eccentricity of every person.
+
+    Postcondition: Each component keeps bounds for its unsettled people
+                   and runs BFSs until every pair of bounds meets. People
+                   with one friend share the bounds of that friend.
+-----------------------------------------------------------------------*/
+vector<int> DiameterFinder::eccentricities() const {
+    int count = nodeCount();
+    vector<int> result(count, -1);
+    vector<int> lower(count, 0), upper(count, INT_MAX);
+    TraversalWorkspace::Lease gather = TraversalWorkspace::acquire(count);
+    vector<int> open;
+    for (int start : lists.people) {
+        if (gather->visited(start)) continue;
+        search(lists, start, *gather);
+        open = gather->queue();
+        bool tied = open.size() > 2;
+
+        bool highest = true;
+        while (!open.empty()) {
+            // By turns, the person who may lie farthest out and the one who
+            // may lie most central; ties go to more friends, who reach more
+            int pick = open[0];
+            for (int id : open) {
+                int a = highest ? upper[id] : -lower[id];
+                int b = highest ? upper[pick] : -lower[pick];
+                if (a > b || (a == b && (lists.degree(id) > lists.degree(pick) || (lists.degree(id) == lists.degree(pick) && id < pick)))) {
+                    pick = id;
+                }
+            }
+            highest = !highest;
+
+            TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(count);
+            search(lists, pick, *ws);
+            int reach = ws->distance(ws->queue().back());
+            for (int id : open) {
+                int d = ws->distance(id);
+                lower[id] = max(lower[id], max(d, reach - d));
+                upper[id] = min(upper[id], reach + d);
+            }
+
+            // In a component of more than two, someone with a single friend
+            // lies exactly one hop past that friend from everyone else
+            for (int id : open) {
+                if (!tied || lists.degree(id) != 1) continue;
+                int only = lists.targets[lists.offsets[id]];
+                lower[id] = max(lower[id], lower[only] + 1);
+                upper[id] = min(upper[id], upper[only] + 1);
+                lower[only] = max(lower[only], lower[id] - 1);
+                upper[only] = min(upper[only], upper[id] - 1);
+            }
+
+            size_t kept = 0;
+            for (int id : open) {
+                if (lower[id] == upper[id]) result[id] = lower[id];
+                else open[kept++] = id;
+            }
+            open.resize(kept);
+        }
+    }
+    return result;
+}
+
+/*-----------------------------------------------------------------------
+    Run iFUB on one connected component.
+
+    Postcondition: Two double sweeps, the first from the person with the
+                   most friends and the second from the middle of the path
+                   the first found, give the first lower bound; the middle
+                   of the second path, usually close to the center of the
+                   component, is the person u who roots the levels. Once every person on levels
+                   i and beyond has been searched, any pair still unchecked
+                   lies within level i - 1 of u and so at most 2(i - 1)
+                   apart; the search stops when the lower bound reaches it.
+-----------------------------------------------------------------------*/
+DiameterFinder::Component DiameterFinder::sweep(const vector<int>& members, int threadCount) const {
+    Component component;
+    component.size = (int)members.size();
+    int root = members[0];
+    for (int id : members) {
+        if (lists.degree(id) > lists.degree(root) || (lists.degree(id) == lists.degree(root) && id < root)) root = id;
+    }
+    component.from = component.to = root;
+    if (members.size() == 1) return component;
+
+    int count = nodeCount();
+    int middle = root;
+    for (int round = 0; round < 2; round++) {
+        TraversalWorkspace::Lease there = TraversalWorkspace::acquire(count);
+        search(lists, middle, *there);
+        int first = there->queue().back();
+        TraversalWorkspace::Lease back = TraversalWorkspace::acquire(count);
+        search(lists, first, *back);
+        int second = back->queue().back();
+        int length = back->distance(second);
+        if (length > component.diameter) {
+            component.from = first;
+            component.to = second;
+            component.diameter = length;
+        }
+        middle = second;
+        for (int step = 0; step < length / 2; step++) {
+            middle = back->parent(middle);
+        }
+    }
+    TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(count);
+    search(lists, middle, *ws);
+    component.searches = 5;
+    const vector<int>& order = ws->queue();
+    int height = ws->distance(order.back());
+    if (height > component.diameter) {
+        component.from = middle;
+        component.to = order.back();
+        component.diameter = height;
+    }
+
+    // order is sorted by level, so each level is one slice of it
+    vector<int> eccentricity, farthest;
+    size_t end = order.size();
+    for (int level = height; 2 * level > component.diameter; level--) {
+        size_t begin = end;
+        while (begin > 0 && ws->distance(order[begin - 1]) == level) begin--;
+        int size = (int)(end - begin);
+        eccentricity.assign(size, 0);
+        farthest.assign(size, -1);
+        int threads = ParallelChunks::threadsFor(size, threadCount, 1);
+        ParallelChunks::run(size, threads, [&](int, int low, int high) {
+            for (int i = low; i < high; i++) {
+                TraversalWorkspace::Lease own = TraversalWorkspace::acquire(count);
+                search(lists, order[begin + i], *own);
+                farthest[i] = own->queue().back();
+                eccentricity[i] = own->distance(farthest[i]);
+            }
+        }, 1);
+        component.searches += size;
+        for (int i = 0; i < size; i++) {
+            if (eccentricity[i] <= component.diameter) continue;
+            component.from = order[begin + i];
+            component.to = farthest[i];
+            component.diameter = eccentricity[i];
+        }
+        end = begin;
+    }
+    if (component.from > component.to) swap(component.from, component.to);
+    return component;
+}
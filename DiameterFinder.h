@@ -0,0 +1,107 @@
+/******************************************************************************
+ * Class: DiameterFinder
+ *
+ * Description: Exact diameter of every connected component of the network,
+ *              and optionally the eccentricity of every person (the hops to
+ *              the person farthest from them), without a BFS from everyone.
+ *
+ *              - diameters() (iFUB, Crescenzi et al.): a double sweep from
+ *                the best-connected person of a component finds two people
+ *                far apart, a lower bound; a BFS from the middle of the path
+ *                between them sorts the component into levels. Anyone at
+ *                level i or closer has eccentricity at most 2i, so the
+ *                levels are taken from the outside in, one BFS per person on
+ *                the level, until the largest eccentricity seen exceeds
+ *                twice the next level. On small-world graphs this stops
+ *                after a handful of levels near the fringe. The BFSs of one
+ *                level run in parallel.
+ *              - eccentricities() (Takes and Kosters): every BFS from a
+ *                person v bounds the eccentricity of each w from both sides,
+ *                between max(d, e(v) - d) and e(v) + d for d = d(v, w).
+ *                People whose bounds meet are settled; the next BFS starts
+ *                from the unsettled person with the largest upper bound or
+ *                the smallest lower bound, by turns.
+ *
+ *              Every BFS leases its state from the traversal workspace pool.
+ *
+ *              The BFSs walk a FriendLists copy of the graph view.
+ *
+ * Member Variables:
+ *    - lists: Friend lists of the graph view, searched by every BFS
+ *
+ *****************************************************************************/
+
+#ifndef DIAMETERFINDER_H
+#define DIAMETERFINDER_H
+
+#include "FriendLists.h"
+#include <vector>
+
+using namespace std;
+
+class DiameterFinder {
+public:
+    /***** Component Struct (one connected component) *****/
+    struct Component {
+        int size = 0;                   // People in the component
+        int diameter = 0;               // Longest shortest path, in hops
+        int from = -1;                  // Node IDs of two people diameter
+        int to = -1;                    //   hops apart
+        int searches = 0;               // BFSs it took to prove the diameter
+    };
+
+    /*** Constructer ***/
+    template <class Graph>
+    explicit DiameterFinder(const Graph& graph) : lists(graph) {}
+    /*-------------------------------------------------------------------
+      Prepare to measure the components of a graph view.
+
+      Postcondition: Nothing is searched until diameters() or
+                     eccentricities() is called.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return lists.nodeCount(); }
+    /*-------------------------------------------------------------------
+      Get the size of the node ID space.
+     ------------------------------------------------------------------*/
+
+    /*** Diameters **/
+    vector<Component> diameters(int threadCount = 0) const;
+    /*-------------------------------------------------------------------
+      Find the exact diameter of every connected component.
+
+      Precondition:  threadCount of 0 uses one thread per hardware thread.
+      Postcondition: One element per component, largest first, ties by
+                     lower from. A person without friends is a component
+                     of diameter 0 with from == to.
+     ------------------------------------------------------------------*/
+
+    int diameter(int threadCount = 0) const;
+    /*-------------------------------------------------------------------
+      Find the exact diameter of the network.
+
+      Postcondition: Returns the largest diameter of any component, or 0
+                     without people.
+     ------------------------------------------------------------------*/
+
+    vector<int> eccentricities() const;
+    /*-------------------------------------------------------------------
+      Find the exact eccentricity of every person.
+
+      Postcondition: Element id is the largest distance from node ID id to
+                     anyone in its component, or -1 for removed IDs.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    FriendLists lists;              // Copy of the graph view
+
+    /***** Helper Functions *****/
+    Component sweep(const vector<int>& members, int threadCount) const;
+    /*-----------------------------------------------------------------------
+      Run iFUB on one connected component, given all its members.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
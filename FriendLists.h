@@ -0,0 +1,81 @@
+/******************************************************************************
+ * Struct: FriendLists
+ *
+ * Description: Private copy of the friend lists of a graph view in compressed
+ *              sparse row (CSR) form, for the classes that read the lists
+ *              many times over (the label searches of PrunedLabelIndex, the
+ *              passes of PageRank, ...). Node IDs are those of the view,
+ *              removed IDs included, so results are indexed as the view is.
+ *
+ *              Works on any graph view offering nodeCount(), neighbors(id)
+ *              and isPerson(id) (SocialGraph::Snapshot and GraphSnapshot).
+ *              Both are immutable, so the copy is of a single version.
+ *
+ * Member Variables:
+ *    - offsets: Start of each node ID's friend list inside targets
+ *    - targets: All friend lists back to back, in the order of the view
+ *    - people: Node IDs of living people, in increasing order
+ *    - living: 1 for node IDs of living people, 0 for removed ones
+ *
+ *****************************************************************************/
+
+#ifndef FRIENDLISTS_H
+#define FRIENDLISTS_H
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+struct FriendLists {
+    vector<int> offsets;            // nodeCount() + 1 offsets into targets
+    vector<int> targets;            // Friend IDs
+    vector<int> people;             // Living people
+    vector<uint8_t> living;         // Living people, by node ID
+
+    /*** Constructer ***/
+    template <class Graph>
+    explicit FriendLists(const Graph& graph);
+    /*-------------------------------------------------------------------
+      Copy the friend lists of a graph view.
+
+      Postcondition: Holds every friend list of graph; the view is not
+                     used again.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return (int)offsets.size() - 1; }
+    int degree(int id) const { return offsets[id + 1] - offsets[id]; }
+    bool isPerson(int id) const { return living[id] != 0; }
+    /*-------------------------------------------------------------------
+      Get the size of the node ID space, or the friend count and liveness
+      of one node ID.
+
+      Precondition:  id is below nodeCount().
+     ------------------------------------------------------------------*/
+};
+
+/*-----------------------------------------------------------------------
+    Copy the friend lists of a graph view.
+
+    Postcondition: offsets, targets, people and living describe graph.
+-----------------------------------------------------------------------*/
+template <class Graph>
+FriendLists::FriendLists(const Graph& graph) {
+    int count = graph.nodeCount();
+    offsets.reserve(count + 1);
+    offsets.push_back(0);
+    living.assign(count, 0);
+    for (int id = 0; id < count; id++) {
+        for (int friendId : graph.neighbors(id)) {
+            targets.push_back(friendId);
+        }
+        offsets.push_back((int)targets.size());
+        if (graph.isPerson(id)) {
+            people.push_back(id);
+            living[id] = 1;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,400 @@
+/*-------------------------------------------------------------------------
+  GraphPartitioner.cpp
+
+  - Implementation of the non-template functions mentioned in GraphPartitioner.h
+------------------------------------------------------------------------*/
+#include "GraphPartitioner.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    // Coarsening stops once a level has at most this many nodes per part,
+    // or shrinks by less than a twentieth
+    const int CoarsestPerPart = 16;
+    const int MaxLevels = 40;
+
+    /*-----------------------------------------------------------------------
+        Mix the bits of a 64-bit value (splitmix64 finalizer).
+    -----------------------------------------------------------------------*/
+    uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    /***** Level (one graph of the multilevel hierarchy) *****/
+    // A node stands for one or more people; its weight is how many, and
+    // the weight of an edge is the number of friendships it merges.
+    struct Level {
+        vector<int> offsets;            // Start of each node's edges
+        vector<int> targets;            // Neighbor of each edge
+        vector<int> weights;            // Friendships behind each edge
+        vector<int> nodeWeights;        // People behind each node
+
+        int size() const { return (int)nodeWeights.size(); }
+    };
+
+    /*-----------------------------------------------------------------------
+        Merge matched pairs of nodes of one level into the next.
+
+        Postcondition: Visiting the nodes in a seeded random order, each
+                       unmatched node is matched with the unmatched
+                       neighbor of the same part behind the most
+                       friendships, if the pair weighs at most maxWeight.
+                       coarseOf maps every node to its merged node, and
+                       coarseParts holds the part of each merged node.
+    -----------------------------------------------------------------------*/
+    void coarsen(const Level& fine, const vector<int>& parts, int maxWeight, uint64_t seed,
+                 Level& coarse, vector<int>& coarseOf, vector<int>& coarseParts) {
+        int n = fine.size();
+        vector<int> order(n);
+        for (int v = 0; v < n; v++) {
+            order[v] = v;
+        }
+        for (int i = n - 1; i > 0; i--) {
+            swap(order[i], order[mix(seed + (uint64_t)i) % (uint64_t)(i + 1)]);
+        }
+
+        vector<int> match(n, -1);
+        for (int v : order) {
+            if (match[v] != -1 || parts[v] < 0) continue;
+            int best = -1, bestWeight = 0;
+            for (int i = fine.offsets[v]; i < fine.offsets[v + 1]; i++) {
+                int u = fine.targets[i];
+                if (match[u] != -1 || u == v || parts[u] != parts[v]) continue;
+                if (fine.nodeWeights[u] + fine.nodeWeights[v] > maxWeight) continue;
+                if (fine.weights[i] > bestWeight) {
+                    best = u;
+                    bestWeight = fine.weights[i];
+                }
+            }
+            match[v] = best == -1 ? v : best;
+            if (best != -1) match[best] = v;
+        }
+
+        // Merged nodes are numbered by their lowest member
+        coarseOf.assign(n, -1);
+        vector<int> members;
+        for (int v = 0; v < n; v++) {
+            if (coarseOf[v] != -1) continue;
+            int partner = match[v] == -1 ? v : match[v];
+            coarseOf[v] = coarseOf[partner] = (int)members.size();
+            members.push_back(v);
+        }
+
+        int count = (int)members.size();
+        coarse = Level();
+        coarse.offsets.reserve(count + 1);
+        coarse.offsets.push_back(0);
+        coarse.nodeWeights.resize(count);
+        coarseParts.resize(count);
+        vector<int> slot(count, -1);   // Position of each neighbor in the current list
+        for (int c = 0; c < count; c++) {
+            int v = members[c], partner = match[v] == -1 ? v : match[v];
+            int start = (int)coarse.targets.size();
+            coarse.nodeWeights[c] = fine.nodeWeights[v] + (partner != v ? fine.nodeWeights[partner] : 0);
+            coarseParts[c] = parts[v];
+            for (int member : { v, partner }) {
+                for (int i = fine.offsets[member]; i < fine.offsets[member + 1]; i++) {
+                    int u = coarseOf[fine.targets[i]];
+                    if (u == c) continue;
+                    if (slot[u] >= start) {
+                        coarse.weights[slot[u]] += fine.weights[i];
+                    }
+                    else {
+                        slot[u] = (int)coarse.targets.size();
+                        coarse.targets.push_back(u);
+                        coarse.weights.push_back(fine.weights[i]);
+                    }
+                }
+                if (partner == v) break;
+            }
+            coarse.offsets.push_back((int)coarse.targets.size());
+        }
+    }
+
+    /*-----------------------------------------------------------------------
+        Move nodes of one level to better parts.
+
+        Postcondition: Each pass visits every node and moves it to the
+                       neighboring part that its edges weigh the most
+                       toward, if that cuts less weight, or the same weight
+                       into a part that ends up smaller than the one left.
+                       No part grows past capacity. Stops after a pass
+                       without moves.
+    -----------------------------------------------------------------------*/
+    void improve(const Level& level, int partCount, int capacity, int passes,
+                 vector<int>& parts, vector<int64_t>& sizes) {
+        vector<int64_t> weightTo(partCount, 0);
+        vector<int> touched;
+        for (int pass = 0; pass < passes; pass++) {
+            bool moved = false;
+            for (int v = 0; v < level.size(); v++) {
+                int from = parts[v];
+                if (from < 0) continue;
+                touched.clear();
+                for (int i = level.offsets[v]; i < level.offsets[v + 1]; i++) {
+                    int part = parts[level.targets[i]];
+                    if (weightTo[part] == 0) touched.push_back(part);
+                    weightTo[part] += level.weights[i];
+                }
+
+                int weight = level.nodeWeights[v];
+                int best = from;
+                int64_t bestGain = 0;
+                for (int part : touched) {
+                    if (part == from || sizes[part] + weight > capacity) continue;
+                    int64_t gain = weightTo[part] - weightTo[from];
+                    bool better = gain > bestGain ||
+                        (gain == bestGain && (best == from ? sizes[part] + weight < sizes[from]
+                                                           : sizes[part] < sizes[best]));
+                    if (gain >= 0 && better) {
+                        best = part;
+                        bestGain = gain;
+                    }
+                }
+                for (int part : touched) {
+                    weightTo[part] = 0;
+                }
+                if (best == from) continue;
+                parts[v] = best;
+                sizes[from] -= weight;
+                sizes[best] += weight;
+                moved = true;
+            }
+            if (!moved) break;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Split the people into parts.
+
+    Postcondition: Streams the people, refines if asked, then counts the
+                   parts and the cut.
+-----------------------------------------------------------------------*/
+GraphPartitioner::Result GraphPartitioner::partition(const Options& options) const {
+    Result result;
+    int partCount = max(1, options.parts);
+    int n = (int)lists.people.size();
+    int capacity = max(1, (int)ceil(max(1.0, options.imbalance) * n / partCount));
+
+    result.parts.assign(nodeCount(), -1);
+    stream(options, capacity, result.parts);
+    if (options.refine && partCount > 1) refine(options, capacity, result.parts);
+
+    result.sizes.assign(partCount, 0);
+    for (int id : lists.people) {
+        result.sizes[result.parts[id]]++;
+        for (int i = lists.offsets[id]; i < lists.offsets[id + 1]; i++) {
+            if (lists.targets[i] > id && result.parts[lists.targets[i]] != result.parts[id]) result.cutEdges++;
+        }
+    }
+    if (n > 0) {
+        result.balance = *max_element(result.sizes.begin(), result.sizes.end()) * (double)partCount / n;
+    }
+    return result;
+}
+
+/*-----------------------------------------------------------------------
+    Place every person by the streaming heuristic of options.
+
+    Postcondition: People are taken in node ID order. Each goes to the
+                   open part with the best score, ties to the smaller part,
+                   then the lower number. A part without friends of the
+                   person scores by its size alone, so of those parts only
+                   the smallest is scored: O(friends + log parts) a person.
+-----------------------------------------------------------------------*/
+void GraphPartitioner::stream(const Options& options, int capacity, vector<int>& parts) const {
+    int partCount = max(1, options.parts);
+    double n = (double)lists.people.size();
+    double m = lists.targets.size() / 2.0;
+    double gamma = options.gamma;
+    double alpha = n > 0 ? m * pow((double)partCount, gamma - 1) / pow(n, gamma) : 0.0;
+
+    // Fennel's penalty of each part only changes when the part grows
+    bool fennel = options.method == Options::Fennel;
+    vector<int> sizes(partCount, 0);
+    vector<double> penalty(partCount, 0.0);
+    set<pair<int, int>> open;       // (size, part) of every part with room
+    for (int part = 0; part < partCount; part++) {
+        open.emplace(0, part);
+    }
+    vector<int> friendsIn(partCount, 0);
+    vector<int> candidates;
+    for (int v : lists.people) {
+        candidates.clear();
+        for (int i = lists.offsets[v]; i < lists.offsets[v + 1]; i++) {
+            int part = parts[lists.targets[i]];
+            if (part < 0) continue;
+            if (friendsIn[part] == 0) candidates.push_back(part);
+            friendsIn[part]++;
+        }
+        candidates.push_back(open.begin()->second);
+
+        int best = -1;
+        double bestScore = 0.0;
+        for (int part : candidates) {
+            if (sizes[part] >= capacity) continue;
+            double score = fennel ? friendsIn[part] - penalty[part]
+                                  : friendsIn[part] * (1.0 - (double)sizes[part] / capacity);
+            bool better = best == -1 || score > bestScore ||
+                (score == bestScore && (sizes[part] < sizes[best] || (sizes[part] == sizes[best] && part < best)));
+            if (better) {
+                best = part;
+                bestScore = score;
+            }
+        }
+        for (int part : candidates) {
+            friendsIn[part] = 0;
+        }
+
+        parts[v] = best;
+        open.erase(make_pair(sizes[best], best));
+        sizes[best]++;
+        if (sizes[best] < capacity) open.emplace(sizes[best], best);
+        if (fennel) penalty[best] = alpha * gamma * pow((double)sizes[best], gamma - 1);
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Improve the parts by coarsening and refining level by level.
+
+    Postcondition: Levels are coarsened without crossing parts, so the
+                   streamed parts carry over to every level. The smallest
+                   level is refined first; each finer level then starts
+                   from the parts of the level above it.
+-----------------------------------------------------------------------*/
+void GraphPartitioner::refine(const Options& options, int capacity, vector<int>& parts) const {
+    int partCount = max(1, options.parts);
+    vector<Level> levels(1);
+    Level& network = levels[0];
+    network.offsets = lists.offsets;
+    network.targets = lists.targets;
+    network.weights.assign(lists.targets.size(), 1);
+    network.nodeWeights.assign(nodeCount(), 0);
+    for (int id : lists.people) {
+        network.nodeWeights[id] = 1;
+    }
+
+    // A merged node may hold up to an eighth of a part, so moving it
+    // still leaves room for balance
+    int maxWeight = max(2, capacity / 8);
+    vector<vector<int>> levelParts(1, parts);
+    vector<vector<int>> coarseOf;
+    int stopSize = partCount * CoarsestPerPart;
+    while ((int)levels.size() < MaxLevels) {
+        int size = levels.back().size();
+        if (size <= stopSize) break;
+        Level coarse;
+        vector<int> map, coarseParts;
+        coarsen(levels.back(), levelParts.back(), maxWeight, mix(options.seed + levels.size()), coarse, map, coarseParts);
+        if (coarse.size() > size - size / 20) break;
+        levels.push_back(move(coarse));
+        levelParts.push_back(move(coarseParts));
+        coarseOf.push_back(move(map));
+    }
+
+    vector<int64_t> sizes(partCount, 0);
+    for (int id : lists.people) {
+        sizes[parts[id]]++;
+    }
+    for (int level = (int)levels.size() - 1; level >= 0; level--) {
+        vector<int>& current = levelParts[level];
+        if (level + 1 < (int)levels.size()) {
+            const vector<int>& above = levelParts[level + 1];
+            const vector<int>& map = coarseOf[level];
+            for (int v = 0; v < levels[level].size(); v++) {
+                current[v] = above[map[v]];
+            }
+        }
+        improve(levels[level], partCount, capacity, options.refinePasses, current, sizes);
+    }
+    parts.swap(levelParts[0]);
+}
+
+/*-----------------------------------------------------------------------
+    Write the shard and ghost files.
+
+    Postcondition: People are grouped by part in one pass; each part's
+                   ghosts are listed once, in the order first met.
+-----------------------------------------------------------------------*/
+bool GraphPartitioner::writeShards(const vector<string_view>& names, const Result& result,
+                                   const string& filePrefix) const {
+    int partCount = (int)result.sizes.size();
+    vector<vector<int>> members(partCount);
+    for (int id : lists.people) {
+        members[result.parts[id]].push_back(id);
+    }
+
+    vector<int> listedFor(nodeCount(), -1);   // Last part whose ghost list has the ID
+    for (int part = 0; part < partCount; part++) {
+        string base = filePrefix + "." + to_string(part);
+        ofstream shardFile(base + ".txt");
+        ofstream ghostFile(base + ".ghosts");
+        if (!shardFile || !ghostFile) {
+            cerr << "Error: Could not open file for writing: " << base << endl;
+            return false;
+        }
+
+        vector<int> ghosts;
+        for (int id : members[part]) {
+            shardFile << names[id] << ": ";
+            for (int i = lists.offsets[id]; i < lists.offsets[id + 1]; i++) {
+                int friendId = lists.targets[i];
+                shardFile << names[friendId];
+                if (i != lists.offsets[id + 1] - 1) shardFile << " ";
+                if (result.parts[friendId] != part && listedFor[friendId] != part) {
+                    listedFor[friendId] = part;
+                    ghosts.push_back(friendId);
+                }
+            }
+            shardFile << "\n";
+        }
+        for (int ghost : ghosts) {
+            ghostFile << names[ghost] << " " << result.parts[ghost] << "\n";
+        }
+        if (!shardFile || !ghostFile) {
+            cerr << "Error: Could not write shard: " << base << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------
+    Read a ghost list written by saveShards().
+
+    Postcondition: Returns false without changing ghosts if the file
+                   can't be opened or a line is malformed.
+-----------------------------------------------------------------------*/
+bool GraphPartitioner::loadGhosts(const string& ghostFile, vector<pair<string, int>>& ghosts) {
+    ifstream inFile(ghostFile);
+    if (!inFile) {
+        cerr << "Error: Could not open file: " << ghostFile << endl;
+        return false;
+    }
+
+    vector<pair<string, int>> loaded;
+    string line;
+    while (getline(inFile, line)) {
+        if (line.empty()) continue;
+        istringstream fields(line);
+        string name;
+        int part = -1;
+        if (!(fields >> name >> part) || part < 0) {
+            cerr << "Error: Malformed ghost line in " << ghostFile << ": " << line << endl;
+            return false;
+        }
+        loaded.emplace_back(name, part);
+    }
+    ghosts.swap(loaded);
+    return true;
+}
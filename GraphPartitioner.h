@@ -0,0 +1,153 @@
+/******************************************************************************
+ * Class: GraphPartitioner
+ *
+ * Description: Splits the network into a number of parts of about the same
+ *              number of people while cutting as few friendships as
+ *              possible, so that each part can be served by a process of
+ *              its own.
+ *
+ *              People are placed one at a time, in the order they joined,
+ *              by a streaming heuristic that weighs the friends already in
+ *              a part against how full it is:
+ *
+ *              - LinearDeterministicGreedy (Stanton and Kliot): the part
+ *                with the most friends, scaled by its free room.
+ *              - Fennel (Tsourakakis et al.): the part with the most friends
+ *                minus a penalty growing with its size to the power gamma.
+ *
+ *              Either way no part grows past imbalance times an even split.
+ *              The optional refinement then improves the streamed parts as
+ *              a multilevel method does: friends in the same part are
+ *              matched along the heaviest friendships and merged, over and
+ *              over, into smaller graphs; then, from the smallest graph
+ *              back to the network, people (or merged groups) move to the
+ *              part holding more of their friendships while the sizes stay
+ *              within bounds. A move never cuts more friendships.
+ *
+ *              saveShards() writes each part in the format of
+ *              SocialGraph::loadFromFile, every person with all friends,
+ *              next to a list of the ghosts: people of other parts who are
+ *              friends of someone in the part, with the part that owns
+ *              them. Loading a shard gives the process its people, their
+ *              friendships and the ghosts at the boundary.
+ *
+ *              People are streamed from a FriendLists copy of the graph
+ *              view; saving also needs the view's nameOf(id).
+ *
+ * Member Variables:
+ *    - lists: Friend lists of the graph view, streamed in node ID order
+ *
+ *****************************************************************************/
+
+#ifndef GRAPHPARTITIONER_H
+#define GRAPHPARTITIONER_H
+
+#include "FriendLists.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class GraphPartitioner {
+public:
+    /***** Options Struct (controls of one partitioning) *****/
+    struct Options {
+        enum Method { LinearDeterministicGreedy, Fennel };
+        int parts = 2;                  // Number of parts
+        Method method = Fennel;         // Streaming heuristic placing each person
+        double imbalance = 1.03;        // Largest part allowed, relative to an even split
+        double gamma = 1.5;             // Exponent of Fennel's size penalty
+        bool refine = false;            // Improve the streamed parts by multilevel refinement
+        int refinePasses = 4;           // Most passes over each level of the refinement
+        uint64_t seed = 1;              // Orders the matching of the refinement
+    };
+
+    /***** Result Struct (outcome of one partitioning) *****/
+    struct Result {
+        vector<int> parts;              // Part of each node ID; -1 for removed IDs
+        vector<int> sizes;              // People in each part
+        int64_t cutEdges = 0;           // Friendships between people of different parts
+        double balance = 0.0;           // Largest part over an even split
+    };
+
+    /*** Constructer ***/
+    template <class Graph>
+    explicit GraphPartitioner(const Graph& graph) : lists(graph) {}
+    /*-------------------------------------------------------------------
+      Prepare to partition the people of a graph view.
+
+      Postcondition: Every partition() splits the same people; nothing is
+                     placed yet.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return lists.nodeCount(); }
+    /*-------------------------------------------------------------------
+      Get the size of the node ID space.
+     ------------------------------------------------------------------*/
+
+    /*** Partitioning **/
+    Result partition() const { return partition(Options()); }
+    Result partition(const Options& options) const;
+    /*-------------------------------------------------------------------
+      Split the people into parts.
+
+      Precondition:  options.imbalance >= 1 (smaller values count as 1).
+      Postcondition: Every person is in one of options.parts parts, none
+                     holding more than ceil(imbalance * people / parts).
+                     Same options give the same parts.
+     ------------------------------------------------------------------*/
+
+    /*** Persistence **/
+    template <class Graph>
+    bool saveShards(const Graph& graph, const Result& result, const string& filePrefix) const {
+        vector<string_view> names(nodeCount());
+        for (int id : lists.people) {
+            names[id] = graph.nameOf(id);
+        }
+        return writeShards(names, result, filePrefix);
+    }
+    /*-------------------------------------------------------------------
+      Write one shard per part.
+
+      Precondition:  graph is the view the partitioner was built from and
+                     result came from partition().
+      Postcondition: Part p is written to filePrefix.p.txt, one line
+                     "name: friend1 friend2 ..." per person of the part,
+                     and filePrefix.p.ghosts, one line "name part" per
+                     ghost. Returns true if every file was written.
+     ------------------------------------------------------------------*/
+
+    static bool loadGhosts(const string& ghostFile, vector<pair<string, int>>& ghosts);
+    /*-------------------------------------------------------------------
+      Read a ghost list written by saveShards().
+
+      Postcondition: Returns true and fills ghosts with (name, owning part)
+                     if the file was read; otherwise ghosts is unchanged.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    FriendLists lists;              // Copy of the graph view
+
+    /***** Helper Functions *****/
+    void stream(const Options& options, int capacity, vector<int>& parts) const;
+    /*-----------------------------------------------------------------------
+      Place every person by the streaming heuristic of options.
+     ----------------------------------------------------------------------*/
+
+    void refine(const Options& options, int capacity, vector<int>& parts) const;
+    /*-----------------------------------------------------------------------
+      Improve the parts by coarsening and refining level by level.
+     ----------------------------------------------------------------------*/
+
+    bool writeShards(const vector<string_view>& names, const Result& result, const string& filePrefix) const;
+    /*-----------------------------------------------------------------------
+      Write the shard and ghost files, given the name of each node ID.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
@@ -0,0 +1,189 @@
+/*-------------------------------------------------------------------------
+  GraphSnapshot.cpp
+
+  - Implementation of all functions mentioned in GraphSnapshot.h
+------------------------------------------------------------------------*/
+#include "GraphSnapshot.h"
+#include "CommunityDetector.h"
+#include <algorithm>
+#include <queue>
+
+using namespace std;
+
+/*-----------------------------------------------------------------------
+    Freeze the current contents of a graph.
+
+    Precondition:  graph is a valid SocialGraph.
+    Postcondition: The snapshot holds every person and friendship of graph
+                  in CSR form, relabeled according to order.
+-----------------------------------------------------------------------*/
+GraphSnapshot::GraphSnapshot(const SocialGraph& graph, NodeOrder order)
+    // Freeze whichever version is current; writers may carry on meanwhile
+    : GraphSnapshot(graph.snapshot(), order) {}
+
+/*-----------------------------------------------------------------------
+    Freeze one version of a graph.
+
+    Precondition:  version is a snapshot of a SocialGraph.
+    Postcondition: The snapshot holds every person and friendship of
+                  version in CSR form, relabeled according to order.
+-----------------------------------------------------------------------*/
+GraphSnapshot::GraphSnapshot(const SocialGraph::Snapshot& version, NodeOrder order) {
+    const SocialGraph::State& state = *version.state;
+
+    // Compact the graph's node IDs, skipping people who were removed
+    int graphIdCount = state.people.size();
+    vector<int> compactIds(graphIdCount, -1);
+    vector<int> graphIds;
+    state.people.forEach([&](int id, const shared_ptr<const SocialGraph::Person>& person) {
+        if (person) {
+            compactIds[id] = (int)graphIds.size();
+            graphIds.push_back(id);
+        }
+    });
+
+    int count = (int)graphIds.size();
+    vector<vector<int>> adjacency(count);
+    for (int i = 0; i < count; i++) {
+        const ChunkedArray<int>& friends = state.person(graphIds[i])->friends;
+        adjacency[i].reserve(friends.size());
+        for (int friendId : friends) {
+            adjacency[i].push_back(compactIds[friendId]);
+        }
+    }
+
+    // Community order needs the communities of the compacted nodes
+    vector<int> communities;
+    if (order == NodeOrder::Community) {
+        vector<int> labels = CommunityDetector(version).louvain();
+        communities.resize(count);
+        for (int i = 0; i < count; i++) {
+            communities[i] = labels[graphIds[i]];
+        }
+    }
+
+    // Relabel: the i-th node of the order gets snapshot ID i
+    vector<int> visitOrder = computeOrder(adjacency, order, communities);
+    vector<int> newIds(count);
+    for (int i = 0; i < count; i++) {
+        newIds[visitOrder[i]] = i;
+    }
+
+    originalIds.resize(count);
+    snapshotIds.assign(graphIdCount, -1);
+    names.reserve(count);
+    nameIndex.reserve(count);
+    offsets.reserve(count + 1);
+    targets.reserve(state.friendshipCount * 2);
+    offsets.push_back(0);
+    for (int i = 0; i < count; i++) {
+        int old = visitOrder[i];
+        originalIds[i] = graphIds[old];
+        snapshotIds[graphIds[old]] = i;
+        names.push_back(nameArena.store(state.person(graphIds[old])->name));
+        nameIndex.emplace(names.back(), i);
+
+        // Sorted friend lists keep scans sequential and allow merging
+        size_t first = targets.size();
+        for (int neighbor : adjacency[old]) {
+            targets.push_back(newIds[neighbor]);
+        }
+        sort(targets.begin() + first, targets.end());
+        offsets.push_back((int)targets.size());
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Look up the snapshot ID of a person.
+
+    Precondition:  name is the person to find.
+    Postcondition: Returns the snapshot ID, or -1 if name is not present.
+-----------------------------------------------------------------------*/
+int GraphSnapshot::findId(string_view name) const {
+    auto it = nameIndex.find(name);
+    return it == nameIndex.end() ? -1 : it->second;
+}
+
+/*-----------------------------------------------------------------------
+    Compute the visiting order used to relabel the nodes.
+
+    Precondition:  adjacency holds the friend list of every node, and
+                  communities the community of every node if order is
+                  NodeOrder::Community.
+    Postcondition: Returns every node ID exactly once, in the new order.
+-----------------------------------------------------------------------*/
+vector<int> GraphSnapshot::computeOrder(const vector<vector<int>>& adjacency, NodeOrder order,
+                                        const vector<int>& communities) {
+    int count = (int)adjacency.size();
+    vector<int> result(count);
+    for (int i = 0; i < count; i++) result[i] = i;
+    if (order == NodeOrder::Insertion) return result;
+
+    auto byDegreeDesc = [&adjacency](int a, int b) {
+        return adjacency[a].size() > adjacency[b].size();
+    };
+    auto byDegreeAsc = [&adjacency](int a, int b) {
+        return adjacency[a].size() < adjacency[b].size();
+    };
+
+    if (order == NodeOrder::Degree) {
+        // Hubs first, ties keep insertion order
+        stable_sort(result.begin(), result.end(), byDegreeDesc);
+        return result;
+    }
+
+    // BFS, Cuthill-McKee and community order all sweep component by
+    // component; they only differ in where a component starts and how
+    // neighbors are queued. The community order treats every community
+    // as a graph of its own and takes the communities one by one, so
+    // each community ends up in one block of snapshot IDs.
+    bool cuthillMcKee = (order == NodeOrder::ReverseCuthillMcKee);
+    bool byCommunity = (order == NodeOrder::Community);
+    vector<int> roots = result;
+    if (cuthillMcKee) {
+        stable_sort(roots.begin(), roots.end(), byDegreeAsc);
+    }
+    else {
+        stable_sort(roots.begin(), roots.end(), byDegreeDesc);
+    }
+    if (byCommunity) {
+        stable_sort(roots.begin(), roots.end(), [&communities](int a, int b) {
+            return communities[a] < communities[b];
+        });
+    }
+
+    vector<bool> visited(count, false);
+    vector<int> neighbors;
+    result.clear();
+    for (int root : roots) {
+        if (visited[root]) continue;
+
+        queue<int> q;
+        q.push(root);
+        visited[root] = true;
+        while (!q.empty()) {
+            int current = q.front();
+            q.pop();
+            result.push_back(current);
+
+            neighbors.clear();
+            for (int neighbor : adjacency[current]) {
+                if (visited[neighbor]) continue;
+                if (byCommunity && communities[neighbor] != communities[current]) continue;
+                neighbors.push_back(neighbor);
+            }
+            if (cuthillMcKee) {
+                stable_sort(neighbors.begin(), neighbors.end(), byDegreeAsc);
+            }
+            for (int neighbor : neighbors) {
+                visited[neighbor] = true;
+                q.push(neighbor);
+            }
+        }
+    }
+
+    if (cuthillMcKee) {
+        reverse(result.begin(), result.end());
+    }
+    return result;
+}
@@ -0,0 +1,167 @@
+/******************************************************************************
+ * Class: GraphSnapshot
+ *
+ * Description: Frozen, read-only copy of a SocialGraph stored in compressed
+ *              sparse row (CSR) form. When the snapshot is frozen the people
+ *              can be relabeled so that friends sit close together in memory,
+ *              which keeps traversals over the snapshot cache friendly.
+ *              The community order runs Louvain (CommunityDetector) on the
+ *              version first, so freezing that way takes a few extra passes
+ *              over the network.
+ *
+ * Member Variables:
+ *    - nameArena: Storage for the names of the snapshot
+ *    - names: Name of each person, indexed by snapshot ID
+ *    - offsets: Start of each person's friend list inside targets
+ *    - targets: All friend lists back to back (snapshot IDs, sorted)
+ *    - originalIds: SocialGraph node ID of each snapshot ID
+ *    - snapshotIds: Snapshot ID of each SocialGraph node ID
+ *    - nameIndex: Maps a name to its snapshot ID
+ *
+ *****************************************************************************/
+
+#ifndef GRAPHSNAPSHOT_H
+#define GRAPHSNAPSHOT_H
+
+#include "SocialGraph.h"
+#include "NameArena.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+/***** Node relabeling applied when a snapshot is frozen *****/
+enum class NodeOrder {
+    Insertion,              // Keep the order people were added in
+    Degree,                 // Most connected people first
+    BreadthFirst,           // BFS order, starting from the most connected person
+    ReverseCuthillMcKee,    // Bandwidth-reducing order, good for sparse graphs
+    Community               // Louvain communities one after another, BFS order inside each
+};
+
+class GraphSnapshot {
+public:
+    /*** Constructer ***/
+    explicit GraphSnapshot(const SocialGraph& graph, NodeOrder order = NodeOrder::Insertion);
+    /*-------------------------------------------------------------------
+      Freeze the current contents of a graph.
+
+      Precondition:  graph is a valid SocialGraph.
+      Postcondition: The snapshot holds every person and friendship of
+                     graph, relabeled according to order. Later changes
+                     to graph do not affect the snapshot.
+     ------------------------------------------------------------------*/
+
+    explicit GraphSnapshot(const SocialGraph::Snapshot& version, NodeOrder order = NodeOrder::Insertion);
+    /*-------------------------------------------------------------------
+      Freeze one version of a graph.
+
+      Precondition:  version is a snapshot taken from a SocialGraph.
+      Postcondition: The snapshot holds every person and friendship of
+                     that version, relabeled according to order. Node IDs
+                     map back to the version's node IDs.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return (int)names.size(); }
+    /*-------------------------------------------------------------------
+      Get the number of people in the snapshot.
+
+      Postcondition: Snapshot IDs range over [0, nodeCount()).
+     ------------------------------------------------------------------*/
+
+    size_t edgeCount() const { return targets.size() / 2; }
+    /*-------------------------------------------------------------------
+      Get the number of friendships in the snapshot.
+
+      Postcondition: Each friendship is counted once.
+     ------------------------------------------------------------------*/
+
+    bool isPerson(int id) const { return id >= 0 && id < nodeCount(); }
+    /*-------------------------------------------------------------------
+      Check if a snapshot ID belongs to a person.
+
+      Postcondition: Removed people are left out when freezing, so every
+                     snapshot ID is a person. Lets algorithms written for
+                     SocialGraph views skip removed IDs.
+     ------------------------------------------------------------------*/
+
+    int degree(int id) const { return offsets[id + 1] - offsets[id]; }
+    /*-------------------------------------------------------------------
+      Get the number of friends of a person.
+
+      Precondition:  id is a valid snapshot ID.
+      Postcondition: The size of the person's friend list is returned.
+     ------------------------------------------------------------------*/
+
+    SocialGraph::NeighborRange neighbors(int id) const {
+        return SocialGraph::NeighborRange(targets.data() + offsets[id], targets.data() + offsets[id + 1]);
+    }
+    /*-------------------------------------------------------------------
+      Get the friend list of a person without copying it.
+
+      Precondition:  id is a valid snapshot ID.
+      Postcondition: Returns a view of the snapshot IDs of the person's
+                     friends in increasing order, valid for the lifetime
+                     of the snapshot.
+     ------------------------------------------------------------------*/
+
+    string_view getName(int id) const { return names[id]; }
+    /*-------------------------------------------------------------------
+      Get the name of a person.
+
+      Precondition:  id is a valid snapshot ID.
+      Postcondition: The person's name is returned.
+     ------------------------------------------------------------------*/
+
+    int findId(string_view name) const;
+    /*-------------------------------------------------------------------
+      Look up the snapshot ID of a person.
+
+      Precondition:  name is the person to find.
+      Postcondition: Returns the snapshot ID, or -1 if name is not present.
+     ------------------------------------------------------------------*/
+
+    int originalId(int id) const { return originalIds[id]; }
+    /*-------------------------------------------------------------------
+      Map a snapshot ID back to the node ID used by the SocialGraph.
+
+      Precondition:  id is a valid snapshot ID.
+      Postcondition: The SocialGraph node ID the snapshot was built from
+                     is returned.
+     ------------------------------------------------------------------*/
+
+    const vector<int>& getPermutation() const { return snapshotIds; }
+    /*-------------------------------------------------------------------
+      Get the relabeling applied when the snapshot was frozen.
+
+      Postcondition: Element i is the snapshot ID given to SocialGraph
+                     node ID i, or -1 if that node ID was removed.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    NameArena nameArena;                // Backing storage for names
+    vector<string_view> names;          // Name of each person
+    vector<int> offsets;                // nodeCount() + 1 offsets into targets
+    vector<int> targets;                // Friend lists back to back
+    vector<int> originalIds;            // Snapshot ID -> SocialGraph node ID
+    vector<int> snapshotIds;            // SocialGraph node ID -> snapshot ID
+    unordered_map<string_view, int> nameIndex;
+
+    /***** Helper Functions *****/
+    static vector<int> computeOrder(const vector<vector<int>>& adjacency, NodeOrder order,
+                                    const vector<int>& communities);
+    /*-----------------------------------------------------------------------
+      Compute the visiting order used to relabel the nodes.
+
+      Precondition:  adjacency holds the friend list of every node; for
+                     NodeOrder::Community, communities holds the community
+                     of every node.
+      Postcondition: Returns the old node IDs listed in their new order.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
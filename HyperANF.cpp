@@ -0,0 +1,178 @@
+/*-------------------------------------------------------------------------
+  HyperANF.cpp
+
+  - Implementation of the non-template functions mentioned in HyperANF.h
+------------------------------------------------------------------------*/
+#include "HyperANF.h"
+#include "ParallelChunks.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+    /*-----------------------------------------------------------------------
+        Mix the bits of a 64-bit value (splitmix64 finalizer).
+    -----------------------------------------------------------------------*/
+    uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    // Registers are bytes packed eight to a word. They never exceed 127,
+    // so the top bit of every byte is free for the comparisons of merge().
+    const uint64_t HighBits = 0x8080808080808080ULL;
+
+    /*-----------------------------------------------------------------------
+        Estimate the size of the set behind one counter.
+
+        Postcondition: Uses the HyperLogLog harmonic mean, or linear
+                       counting of the empty registers for small sets. The
+                       powers of two come from a table.
+    -----------------------------------------------------------------------*/
+    double estimate(const uint64_t* words, int wordCount, double alpha) {
+        static const vector<double> powers = [] {
+            vector<double> table(128);
+            for (int r = 0; r < 128; r++) {
+                table[r] = ldexp(1.0, -r);
+            }
+            return table;
+        }();
+        double sum = 0.0;
+        int empty = 0;
+        for (int w = 0; w < wordCount; w++) {
+            for (int shift = 0; shift < 64; shift += 8) {
+                int value = (int)((words[w] >> shift) & 0x7F);
+                sum += powers[value];
+                empty += value == 0;
+            }
+        }
+        double size = 8.0 * wordCount;
+        double guess = alpha * size * size / sum;
+        if (guess <= 2.5 * size && empty > 0) guess = size * log(size / empty);
+        return guess;
+    }
+
+    /*-----------------------------------------------------------------------
+        Merge one counter into another.
+
+        Postcondition: into holds the register-wise maximum; returns true
+                       if any register of into grew. Eight registers are
+                       compared per word without branches: with the top
+                       bit of each byte of a set, a - b keeps it exactly
+                       where a >= b, and no borrow crosses a byte.
+    -----------------------------------------------------------------------*/
+    bool merge(uint64_t* into, const uint64_t* from, int wordCount) {
+        uint64_t grew = 0;
+        for (int w = 0; w < wordCount; w++) {
+            uint64_t a = into[w], b = from[w];
+            uint64_t keep = (((a | HighBits) - b) & HighBits) >> 7;
+            keep *= 0xFF;
+            uint64_t high = (a & keep) | (b & ~keep);
+            grew |= high ^ a;
+            into[w] = high;
+        }
+        return grew != 0;
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Estimate the neighborhood function.
+
+    Postcondition: One pass per hop until no counter changes.
+-----------------------------------------------------------------------*/
+HyperANF::Result HyperANF::run(const Options& options) const {
+    int count = nodeCount();
+    int bits = max(4, min(16, options.registerBits));
+    int size = 1 << bits, words = size / 8;
+    double alpha = size == 16 ? 0.673 : size == 32 ? 0.697 : size == 64 ? 0.709 : 0.7213 / (1 + 1.079 / size);
+
+    // Each person's counter starts with just them: one register, picked by
+    // the top bits of a hash, holds the position of the first 1 bit after
+    vector<uint64_t> current((size_t)count * words, 0);
+    vector<double> sizes(count, 0.0);
+    vector<uint8_t> changed(count, 0), changedNext(count, 0);
+    for (int id = 0; id < count; id++) {
+        if (!lists.isPerson(id)) continue;
+        uint64_t hash = mix(options.seed ^ mix((uint64_t)id));
+        uint64_t rest = hash << bits;
+        int rank = 1;
+        while (rank <= 64 - bits && !(rest >> 63)) {
+            rank++;
+            rest <<= 1;
+        }
+        uint64_t slot = hash >> (64 - bits);
+        current[(size_t)id * words + slot / 8] |= (uint64_t)rank << (8 * (slot % 8));
+        sizes[id] = estimate(&current[(size_t)id * words], words, alpha);
+        changed[id] = 1;
+    }
+    vector<uint64_t> next = current;
+
+    Result result;
+    double total = 0.0;
+    for (double personal : sizes) {
+        total += personal;
+    }
+    result.neighborhood.push_back(total);
+
+    int threadCount = ParallelChunks::threadsFor(count, options.threadCount);
+    while (result.iterations < options.maxIterations) {
+        atomic<bool> any(false);
+        ParallelChunks::run(count, threadCount, [&](int, int first, int end) {
+            bool grew = false;
+            for (int v = first; v < end; v++) {
+                changedNext[v] = 0;
+                if (!lists.isPerson(v)) continue;
+                uint64_t* into = &next[(size_t)v * words];
+                copy_n(&current[(size_t)v * words], words, into);
+                bool mine = false;
+                for (int i = lists.offsets[v]; i < lists.offsets[v + 1]; i++) {
+                    int u = lists.targets[i];
+                    if (changed[u]) mine |= merge(into, &current[(size_t)u * words], words);
+                }
+                if (mine) {
+                    changedNext[v] = 1;
+                    sizes[v] = estimate(into, words, alpha);
+                    grew = true;
+                }
+            }
+            if (grew) any.store(true, memory_order_relaxed);
+        });
+        if (!any.load()) {
+            result.converged = true;
+            break;
+        }
+
+        result.iterations++;
+        current.swap(next);
+        changed.swap(changedNext);
+        total = 0.0;
+        for (double personal : sizes) {
+            total += personal;
+        }
+        result.neighborhood.push_back(total);
+    }
+
+    // Average over connected pairs of distinct people: a pair at distance
+    // d is missing from N(t) for each t < d
+    const vector<double>& reach = result.neighborhood;
+    double last = reach.back(), pairs = last - reach[0];
+    if (pairs <= 0) return result;
+    double missing = 0.0;
+    for (size_t t = 0; t + 1 < reach.size(); t++) {
+        missing += last - reach[t];
+    }
+    result.averageDistance = missing / pairs;
+
+    double goal = options.fraction * last;
+    for (size_t t = 0; t < reach.size(); t++) {
+        if (reach[t] < goal) continue;
+        double step = t == 0 ? 0.0 : reach[t] - reach[t - 1];
+        result.effectiveDiameter = step <= 0 ? (double)t : t - 1 + (goal - reach[t - 1]) / step;
+        break;
+    }
+    return result;
+}
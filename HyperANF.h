@@ -0,0 +1,99 @@
+/******************************************************************************
+ * Class: HyperANF
+ *
+ * Description: Approximate neighborhood function of the network (Boldi,
+ *              Rosa and Vigna): N(t), the number of ordered pairs of people
+ *              at most t hops apart, for every t up to the diameter, and
+ *              from it the average degrees of separation and the effective
+ *              diameter. Exact figures need a BFS from every person.
+ *
+ *              Every person holds a HyperLogLog counter, a small array of
+ *              byte registers that estimates the size of a set; at first
+ *              the set is just that person. Pass t replaces each counter
+ *              with the union of itself and the counters of all friends,
+ *              so it then holds the people within t hops. The union of two
+ *              counters is the register-wise maximum, taken eight registers
+ *              at a time in 64-bit words by branch-free bit arithmetic, so
+ *              it runs vectorized without depending on the compiler. Counters
+ *              that did not change in the last pass have nothing new to
+ *              give, so only changed friends are merged, and the process
+ *              stops once no counter changes. Each pass reads the previous
+ *              counters and writes new ones, so people are split over
+ *              threads in chunks without locks.
+ *
+ *              Memory is 2 x people x 2^registerBits bytes. With 2^b
+ *              registers one counter is off by about 1.04 / sqrt(2^b); the
+ *              errors largely cancel in the sum N(t).
+ *
+ *              Counters are merged along a FriendLists copy of the graph
+ *              view, so the view can be dropped once the estimator exists.
+ *
+ * Member Variables:
+ *    - lists: Friend lists of the graph view, merged along every pass
+ *
+ *****************************************************************************/
+
+#ifndef HYPERANF_H
+#define HYPERANF_H
+
+#include "FriendLists.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class HyperANF {
+public:
+    /***** Options Struct (controls of one run) *****/
+    struct Options {
+        int registerBits = 6;           // 2^registerBits registers per counter, 4 to 16
+        int maxIterations = 1000;       // Stop after this many passes regardless
+        double fraction = 0.9;          // Share of pairs the effective diameter covers
+        uint64_t seed = 1;              // Seeds the hash of the counters
+        int threadCount = 0;            // 0 uses one thread per hardware thread
+    };
+
+    /***** Result Struct (outcome of one run) *****/
+    struct Result {
+        vector<double> neighborhood;    // Element t estimates N(t)
+        double averageDistance = 0.0;   // Mean hops between connected pairs
+        double effectiveDiameter = 0.0; // Hops covering fraction of the connected pairs
+        int iterations = 0;             // Passes over the friend lists
+        bool converged = false;         // False if maxIterations cut the run short
+    };
+
+    /*** Constructer ***/
+    template <class Graph>
+    explicit HyperANF(const Graph& graph) : lists(graph) {}
+    /*-------------------------------------------------------------------
+      Prepare to estimate the neighborhood function of a graph view.
+
+      Postcondition: The counters live only for the length of run(), so
+                     a HyperANF holds just the friend lists.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return lists.nodeCount(); }
+    /*-------------------------------------------------------------------
+      Get the size of the node ID space.
+     ------------------------------------------------------------------*/
+
+    /*** Neighborhood Function **/
+    Result run() const { return run(Options()); }
+    Result run(const Options& options) const;
+    /*-------------------------------------------------------------------
+      Estimate the neighborhood function.
+
+      Postcondition: neighborhood[0] estimates the number of people and
+                     the last element the number of connected ordered
+                     pairs, self-pairs included. averageDistance and
+                     effectiveDiameter are 0 without friendships; the
+                     effective diameter is interpolated between whole hops.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    FriendLists lists;              // Copy of the graph view
+};
+
+#endif
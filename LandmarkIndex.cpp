@@ -0,0 +1,82 @@
+/*-------------------------------------------------------------------------
+  LandmarkIndex.cpp
+
+  - Implementation of the non-template functions mentioned in LandmarkIndex.h
+------------------------------------------------------------------------*/
+#include "LandmarkIndex.h"
+#include <cstdlib>
+
+using namespace std;
+
+const uint8_t LandmarkIndex::TooFar;
+const uint8_t LandmarkIndex::Unreachable;
+
+/*-----------------------------------------------------------------------
+    Bound the hop distance between two people.
+
+    Precondition:  a and b are node IDs below nodeCount().
+    Postcondition: lower <= d(a,b) <= upper, with upper -1 if unknown.
+-----------------------------------------------------------------------*/
+LandmarkIndex::DistanceBounds LandmarkIndex::bounds(int a, int b) const {
+    DistanceBounds result = { 0, -1, false };
+    if (a == b) {
+        result.upper = 0;
+        return result;
+    }
+
+    int lower = lowerBound(row(a), row(b));
+    if (lower == -1) {
+        result.disconnected = true;
+        return result;
+    }
+    result.lower = lower;
+    result.upper = upperBound(a, b);
+    return result;
+}
+
+/*-----------------------------------------------------------------------
+    Get the lower bound of the distance between two people.
+
+    Precondition:  a and b are node IDs below nodeCount().
+    Postcondition: Returns -1 if a and b are proven disconnected.
+-----------------------------------------------------------------------*/
+int LandmarkIndex::lowerBound(int a, int b) const {
+    return lowerBound(row(a), row(b));
+}
+
+/*-----------------------------------------------------------------------
+    Get the upper bound of the distance between two people.
+
+    Precondition:  a and b are node IDs below nodeCount().
+    Postcondition: Returns the shortest detour through a landmark, or -1
+                  if no landmark reaches both.
+-----------------------------------------------------------------------*/
+int LandmarkIndex::upperBound(int a, int b) const {
+    if (a == b) return 0;
+    const uint8_t* first = row(a);
+    const uint8_t* second = row(b);
+    int best = -1;
+    for (size_t i = 0; i < landmarks.size(); i++) {
+        if (first[i] >= TooFar || second[i] >= TooFar) continue;
+        int detour = first[i] + second[i];
+        if (best == -1 || detour < best) best = detour;
+    }
+    return best;
+}
+
+/*-----------------------------------------------------------------------
+    Lower bound between two rows of the table.
+
+    Postcondition: Returns -1 if a landmark reaches one row's person and
+                  not the other's.
+-----------------------------------------------------------------------*/
+int LandmarkIndex::lowerBound(const uint8_t* a, const uint8_t* b) const {
+    int best = 0;
+    for (size_t i = 0; i < landmarks.size(); i++) {
+        if ((a[i] == Unreachable) != (b[i] == Unreachable)) return -1;
+        // Saturated entries only say "far", which bounds nothing here
+        if (a[i] >= TooFar || b[i] >= TooFar) continue;
+        best = max(best, abs(a[i] - b[i]));
+    }
+    return best;
+}
@@ -0,0 +1,211 @@
+/******************************************************************************
+ * Class: LandmarkIndex
+ *
+ * Description: Distance oracle built from a few landmark people. The hop
+ *              distance from every landmark to every person is computed
+ *              once and stored in one byte per person per landmark, with
+ *              the bytes of one person side by side. By the triangle
+ *              inequality, any two people A and B then satisfy
+ *
+ *                  |d(A,L) - d(B,L)|  <=  d(A,B)  <=  d(A,L) + d(L,B)
+ *
+ *              for every landmark L, so lower and upper bounds on d(A,B)
+ *              take O(#landmarks) byte reads. The lower bound also serves
+ *              as the A* heuristic of an exact path search (ALT), which
+ *              steers the search toward the target instead of expanding
+ *              the whole neighborhood.
+ *
+ *              Node IDs are those of the graph view the index was built
+ *              from (SocialGraph::Snapshot or GraphSnapshot).
+ *
+ * Member Variables:
+ *    - landmarks: Node IDs of the landmarks
+ *    - table: Distance of each person to each landmark, person-major
+ *    - count: Number of node IDs covered
+ *
+ *****************************************************************************/
+
+#ifndef LANDMARKINDEX_H
+#define LANDMARKINDEX_H
+
+#include "ParallelBFS.h"
+#include "TraversalWorkspace.h"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class LandmarkIndex {
+public:
+    static const uint8_t TooFar = 254;          // Distance of 254 or more
+    static const uint8_t Unreachable = 255;     // In another component
+
+    /***** Distance Bounds Struct *****/
+    struct DistanceBounds {
+        int lower;              // The distance is at least this
+        int upper;              // The distance is at most this; -1 if unknown
+        bool disconnected;      // Proven to be in different components
+    };
+
+    /*** Constructer ***/
+    template <class Graph>
+    explicit LandmarkIndex(const Graph& graph, int landmarkCount = 16);
+    /*-------------------------------------------------------------------
+      Pick landmarks and compute their distances.
+
+      Precondition:  landmarkCount > 0.
+      Postcondition: Up to landmarkCount of the best-connected people are
+                     landmarks, no two of them friends. Costs one BFS
+                     (run by ParallelBFS) per landmark.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return count; }
+    const vector<int>& getLandmarks() const { return landmarks; }
+    /*-------------------------------------------------------------------
+      Get the size of the node ID space and the landmark node IDs.
+     ------------------------------------------------------------------*/
+
+    /*** Queries **/
+    DistanceBounds bounds(int a, int b) const;
+    /*-------------------------------------------------------------------
+      Bound the hop distance between two people.
+
+      Precondition:  a and b are node IDs below nodeCount().
+      Postcondition: lower <= d(a,b) <= upper. disconnected is true if a
+                     landmark reaches exactly one of them.
+     ------------------------------------------------------------------*/
+
+    int lowerBound(int a, int b) const;
+    int upperBound(int a, int b) const;
+    /*-------------------------------------------------------------------
+      Get one side of bounds(a, b).
+
+      Postcondition: lowerBound returns -1 once a and b are proven
+                     disconnected; upperBound returns -1 when no landmark
+                     reaches both.
+     ------------------------------------------------------------------*/
+
+    template <class Graph>
+    vector<int> findPath(const Graph& graph, int from, int to) const;
+    /*-------------------------------------------------------------------
+      Find an exact shortest path, using the landmarks to guide the search.
+
+      Precondition:  graph is the view the index was built from.
+      Postcondition: Returns the node IDs of a shortest path from from to
+                     to, or an empty vector if there is none. People proven
+                     to be in another component than to are never visited.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    vector<int> landmarks;          // Node ID of each landmark
+    vector<uint8_t> table;          // count rows of landmarks.size() bytes
+    int count;                      // Node IDs covered
+
+    /***** Helper Functions *****/
+    const uint8_t* row(int id) const { return table.data() + (size_t)id * landmarks.size(); }
+    /*-----------------------------------------------------------------------
+      Get the landmark distances of one person.
+     ----------------------------------------------------------------------*/
+
+    int lowerBound(const uint8_t* a, const uint8_t* b) const;
+    /*-----------------------------------------------------------------------
+      Lower bound between two rows; -1 if they are proven disconnected.
+     ----------------------------------------------------------------------*/
+};
+
+/*-----------------------------------------------------------------------
+    Pick landmarks and compute their distances.
+
+    Precondition:  landmarkCount > 0.
+    Postcondition: table holds the distance of every person to every
+                  landmark.
+-----------------------------------------------------------------------*/
+template <class Graph>
+LandmarkIndex::LandmarkIndex(const Graph& graph, int landmarkCount) : count(graph.nodeCount()) {
+    // Highest degree first, skipping friends of landmarks already picked
+    // so the landmarks cover different parts of the network
+    vector<int> order(count);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&graph](int a, int b) {
+        return graph.neighbors(a).size() > graph.neighbors(b).size();
+    });
+    vector<bool> covered(count, false);
+    for (int id : order) {
+        if ((int)landmarks.size() == landmarkCount) break;
+        if (covered[id] || graph.neighbors(id).empty()) continue;
+        landmarks.push_back(id);
+        covered[id] = true;
+        for (int friendId : graph.neighbors(id)) {
+            covered[friendId] = true;
+        }
+    }
+
+    size_t width = landmarks.size();
+    table.assign((size_t)count * width, Unreachable);
+    for (size_t i = 0; i < width; i++) {
+        vector<int> distance = ParallelBFS::distances(graph, landmarks[i]);
+        for (int id = 0; id < count; id++) {
+            if (distance[id] >= 0) table[id * width + i] = (uint8_t)min(distance[id], (int)TooFar);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Find an exact shortest path, guided by the landmarks (ALT search).
+
+    Precondition:  graph is the view the index was built from.
+    Postcondition: Returns the node IDs of a shortest path, or an empty
+                  vector if to can't be reached.
+-----------------------------------------------------------------------*/
+template <class Graph>
+vector<int> LandmarkIndex::findPath(const Graph& graph, int from, int to) const {
+    vector<int> path;
+    const uint8_t* target = row(to);
+    if (lowerBound(row(from), target) == -1) return path;
+
+    // A* over hop counts: entries are (node, distance when queued),
+    // bucketed by distance + lower bound to the target
+    TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(count);
+    vector<vector<pair<int, int>>> buckets(1);
+    ws->visit(from, -1, 0);
+    buckets[0].emplace_back(from, 0);
+
+    for (size_t f = 0; f < buckets.size(); f++) {
+        while (!buckets[f].empty()) {
+            pair<int, int> entry = buckets[f].back();
+            buckets[f].pop_back();
+            int v = entry.first;
+            if (ws->distance(v) != entry.second) continue;   // Reached sooner since
+
+            if (v == to) {
+                for (int u = to; u != -1; u = ws->parent(u)) {
+                    path.push_back(u);
+                }
+                reverse(path.begin(), path.end());
+                return path;
+            }
+
+            int next = entry.second + 1;
+            for (int w : graph.neighbors(v)) {
+                if (ws->visited(w) && ws->distance(w) <= next) continue;
+                int estimate = lowerBound(row(w), target);
+                if (estimate == -1) continue;   // w can't reach the target
+
+                // Never queue behind the current bucket (the bound is
+                // not exact once distances saturate)
+                size_t key = max(f, (size_t)(next + estimate));
+                if (key >= buckets.size()) buckets.resize(key + 1);
+                ws->visit(w, v, next);
+                buckets[key].emplace_back(w, next);
+            }
+        }
+    }
+    return path;
+}
+
+#endif
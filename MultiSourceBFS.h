@@ -0,0 +1,310 @@
+/******************************************************************************
+ * Class: MultiSourceBFS
+ *
+ * Description: Runs up to 256 breadth-first searches at once (MS-BFS).
+ *              Every node carries a bit per search in a few 64-bit words,
+ *              so one scan of a friend list advances all the searches that
+ *              reached the node at the same level. Batched path queries
+ *              share the adjacency scans instead of repeating them.
+ *
+ *              Queries are grouped by source, one search (lane) per distinct
+ *              source. The graph is undirected, so when the queries share
+ *              fewer targets than sources the searches start from the
+ *              targets instead. Batches of at most 64 lanes use one word
+ *              per node, larger ones four. The lane words take three arrays
+ *              the size of the node ID space, which only pays off for many
+ *              lanes: batches of at most PooledLanes starts run one plain
+ *              BFS per start on the thread's traversal workspace instead.
+ *
+ *              When a query has several shortest paths, the one returned
+ *              depends on the lanes it was batched with and need not be
+ *              the one a single BFS would find.
+ *
+ *              Works on any graph view offering nodeCount() and
+ *              neighbors(id) (SocialGraph::Snapshot and GraphSnapshot).
+ *
+ *****************************************************************************/
+
+#ifndef MULTISOURCEBFS_H
+#define MULTISOURCEBFS_H
+
+#include "TraversalWorkspace.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class MultiSourceBFS {
+public:
+    static const int MaxLanes = 256;    // Searches run together
+    static const int PooledLanes = 4;   // Batches up to this size search start by start
+
+    template <class Graph>
+    static vector<int> distances(const Graph& graph, const vector<pair<int, int>>& queries) {
+        vector<int> distance(queries.size(), -1);
+        solve(graph, queries, distance, nullptr);
+        return distance;
+    }
+    /*-------------------------------------------------------------------
+      Answer a batch of hop distance queries.
+
+      Precondition:  Each query is a (source, target) pair of node IDs.
+      Postcondition: Element i is the distance of query i, or -1 if its
+                     target can't be reached.
+     ------------------------------------------------------------------*/
+
+    template <class Graph>
+    static vector<vector<int>> paths(const Graph& graph, const vector<pair<int, int>>& queries) {
+        vector<int> distance(queries.size(), -1);
+        vector<vector<int>> path(queries.size());
+        solve(graph, queries, distance, &path);
+        return path;
+    }
+    /*-------------------------------------------------------------------
+      Answer a batch of shortest path queries.
+
+      Precondition:  Each query is a (source, target) pair of node IDs.
+      Postcondition: Element i holds the node IDs of a shortest path of
+                     query i, from source to target, or is empty if there
+                     is none. Ties between shortest paths are broken by
+                     whichever search reaches a node first.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Helper Functions *****/
+    template <class Graph>
+    static void solve(const Graph& graph, const vector<pair<int, int>>& queries,
+                      vector<int>& distance, vector<vector<int>>* path) {
+        // Start from whichever side has fewer distinct nodes
+        unordered_set<int> sources, targets;
+        for (const pair<int, int>& query : queries) {
+            sources.insert(query.first);
+            targets.insert(query.second);
+        }
+        bool flipped = targets.size() < sources.size();
+
+        // Give each distinct start node a lane, in batches of MaxLanes
+        vector<int> starts;
+        unordered_map<int, int> laneOf;
+        vector<pair<int, int>> batch;       // (query, lane)
+        auto flush = [&]() {
+            if ((int)starts.size() <= PooledLanes) runPooled(graph, starts, batch, queries, flipped, distance, path);
+            else if (starts.size() <= 64) runBatch<1>(graph, starts, batch, queries, flipped, distance, path);
+            else runBatch<MaxLanes / 64>(graph, starts, batch, queries, flipped, distance, path);
+            starts.clear();
+            laneOf.clear();
+            batch.clear();
+        };
+        for (int i = 0; i < (int)queries.size(); i++) {
+            int start = flipped ? queries[i].second : queries[i].first;
+            auto lane = laneOf.find(start);
+            if (lane == laneOf.end()) {
+                if ((int)starts.size() == MaxLanes) flush();
+                lane = laneOf.emplace(start, (int)starts.size()).first;
+                starts.push_back(start);
+            }
+            batch.emplace_back(i, lane->second);
+        }
+        if (!starts.empty()) flush();
+    }
+    /*-----------------------------------------------------------------------
+      Split the queries into batches and run them.
+
+      Postcondition: distance (and path, unless null) hold every answer.
+     ----------------------------------------------------------------------*/
+
+    template <class Graph>
+    static void runPooled(const Graph& graph, const vector<int>& starts, const vector<pair<int, int>>& batch,
+                          const vector<pair<int, int>>& queries, bool flipped,
+                          vector<int>& distance, vector<vector<int>>* path) {
+        for (int lane = 0; lane < (int)starts.size(); lane++) {
+            vector<int> pending;
+            for (const pair<int, int>& entry : batch) {
+                if (entry.second == lane) pending.push_back(entry.first);
+            }
+
+            TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(graph.nodeCount());
+            vector<int>& queue = ws->queue();
+            ws->visit(starts[lane], -1, 0);
+            queue.push_back(starts[lane]);
+            vector<int> answered;
+            for (size_t head = 0; head < queue.size(); head++) {
+                int v = queue[head], next = ws->distance(v) + 1;
+                for (int w : graph.neighbors(v)) {
+                    if (!ws->visited(w)) {
+                        ws->visit(w, v, next);
+                        queue.push_back(w);
+                    }
+                }
+
+                // Once a level is fully queued, stop if every far end is in it
+                if (head + 1 < queue.size() && ws->distance(queue[head + 1]) == ws->distance(v)) continue;
+                size_t kept = 0;
+                for (int query : pending) {
+                    if (ws->visited(farEnd(queries[query], flipped))) answered.push_back(query);
+                    else pending[kept++] = query;
+                }
+                pending.resize(kept);
+                if (pending.empty()) break;
+            }
+
+            for (int query : answered) {
+                int current = farEnd(queries[query], flipped);
+                distance[query] = ws->distance(current);
+                if (path == nullptr) continue;
+                vector<int>& nodes = (*path)[query];
+                for (; current != -1; current = ws->parent(current)) {
+                    nodes.push_back(current);
+                }
+                // nodes runs from the far end back to the start of the search
+                if (!flipped) reverse(nodes.begin(), nodes.end());
+            }
+        }
+    }
+    /*-----------------------------------------------------------------------
+      Run a small batch as one workspace BFS per start.
+
+      Precondition:  batch pairs each query with the index of its start.
+      Postcondition: Same answers as runBatch; each search stops at the
+                     level of the last far end it has to reach. Costs no
+                     allocation once the thread's workspace has grown to
+                     the graph.
+     ----------------------------------------------------------------------*/
+
+    template <int Words, class Graph>
+    static void runBatch(const Graph& graph, const vector<int>& starts, const vector<pair<int, int>>& batch,
+                         const vector<pair<int, int>>& queries, bool flipped,
+                         vector<int>& distance, vector<vector<int>>* path) {
+        typedef array<uint64_t, Words> Lanes;
+        int count = graph.nodeCount();
+        vector<Lanes> seen(count), visit(count), visitNext(count);
+
+        // Node IDs (and their new lanes) reached at each level, sorted by
+        // node ID; only kept when paths have to be rebuilt
+        vector<vector<pair<int, Lanes>>> levels(1);
+        vector<int> frontier;
+        for (int lane = 0; lane < (int)starts.size(); lane++) {
+            int start = starts[lane];
+            setLane(seen[start], lane);
+            setLane(visit[start], lane);
+            frontier.push_back(start);
+            if (path != nullptr) levels[0].emplace_back(start, visit[start]);
+        }
+        sort(levels[0].begin(), levels[0].end(), byNode<Lanes>);
+
+        vector<pair<int, int>> pending;
+        for (const pair<int, int>& entry : batch) {
+            if (hasLane(seen[farEnd(queries[entry.first], flipped)], entry.second)) distance[entry.first] = 0;
+            else pending.push_back(entry);
+        }
+
+        vector<int> touched;
+        for (int level = 1; !pending.empty() && !frontier.empty(); level++) {
+            // One scan per friend list advances every lane at v together
+            for (int v : frontier) {
+                const Lanes& lanes = visit[v];
+                for (int w : graph.neighbors(v)) {
+                    Lanes& next = visitNext[w];
+                    if (isEmpty(next)) touched.push_back(w);
+                    for (int k = 0; k < Words; k++) next[k] |= lanes[k];
+                }
+            }
+            for (int v : frontier) {
+                visit[v] = Lanes();
+            }
+
+            // Keep only the lanes reaching each node for the first time
+            frontier.clear();
+            if (path != nullptr) levels.emplace_back();
+            for (int w : touched) {
+                Lanes fresh;
+                for (int k = 0; k < Words; k++) {
+                    fresh[k] = visitNext[w][k] & ~seen[w][k];
+                    seen[w][k] |= fresh[k];
+                }
+                visitNext[w] = Lanes();
+                if (isEmpty(fresh)) continue;
+                visit[w] = fresh;
+                frontier.push_back(w);
+                if (path != nullptr) levels.back().emplace_back(w, fresh);
+            }
+            touched.clear();
+            if (path != nullptr) sort(levels.back().begin(), levels.back().end(), byNode<Lanes>);
+
+            size_t kept = 0;
+            for (const pair<int, int>& entry : pending) {
+                if (hasLane(seen[farEnd(queries[entry.first], flipped)], entry.second)) distance[entry.first] = level;
+                else pending[kept++] = entry;
+            }
+            pending.resize(kept);
+        }
+
+        if (path == nullptr) return;
+        for (const pair<int, int>& entry : batch) {
+            int query = entry.first, lane = entry.second;
+            if (distance[query] == -1) continue;
+
+            // Walk back from the far end through nodes the lane reached
+            // one level earlier
+            vector<int>& nodes = (*path)[query];
+            int current = farEnd(queries[query], flipped);
+            nodes.push_back(current);
+            for (int level = distance[query] - 1; level >= 0; level--) {
+                for (int u : graph.neighbors(current)) {
+                    auto found = lower_bound(levels[level].begin(), levels[level].end(),
+                                             make_pair(u, Lanes()), byNode<Lanes>);
+                    if (found != levels[level].end() && found->first == u && hasLane(found->second, lane)) {
+                        current = u;
+                        break;
+                    }
+                }
+                nodes.push_back(current);
+            }
+            // nodes runs from the far end back to the start of the search
+            if (!flipped) reverse(nodes.begin(), nodes.end());
+        }
+    }
+    /*-----------------------------------------------------------------------
+      Run one batch of searches.
+
+      Precondition:  starts holds at most 64 * Words distinct node IDs;
+                     batch pairs each query with the lane of its start.
+      Postcondition: The answers of the queries in batch are filled in.
+                     The batch stops once every one of its queries is
+                     answered or the searches run out of nodes.
+     ----------------------------------------------------------------------*/
+
+    static int farEnd(const pair<int, int>& query, bool flipped) {
+        return flipped ? query.first : query.second;
+    }
+    /*-----------------------------------------------------------------------
+      Get the node a search has to reach to answer a query.
+     ----------------------------------------------------------------------*/
+
+    template <class Lanes>
+    static void setLane(Lanes& lanes, int lane) { lanes[lane >> 6] |= uint64_t(1) << (lane & 63); }
+
+    template <class Lanes>
+    static bool hasLane(const Lanes& lanes, int lane) { return (lanes[lane >> 6] >> (lane & 63)) & 1; }
+
+    template <class Lanes>
+    static bool isEmpty(const Lanes& lanes) {
+        for (uint64_t word : lanes) {
+            if (word != 0) return false;
+        }
+        return true;
+    }
+
+    template <class Lanes>
+    static bool byNode(const pair<int, Lanes>& a, const pair<int, Lanes>& b) { return a.first < b.first; }
+    /*-----------------------------------------------------------------------
+      Bit set helpers over the lane words of a node.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
@@ -0,0 +1,204 @@
+/*-------------------------------------------------------------------------
+  MutationQueue.cpp
+
+  - Implementation of all functions mentioned in MutationQueue.h
+------------------------------------------------------------------------*/
+#include "MutationQueue.h"
+#include <vector>
+
+using namespace std;
+
+/*-----------------------------------------------------------------------
+    Start the applier thread of a graph.
+
+    Precondition:  graph outlives the queue; capacity and maxBatch > 0.
+    Postcondition: Every slot is free and the applier is running.
+-----------------------------------------------------------------------*/
+MutationQueue::MutationQueue(SocialGraph& graph, size_t capacity, size_t maxBatch)
+    : graph(graph), maxBatch(maxBatch), tail(0), head(0),
+      stopping(false), sleeping(false), signalled(false) {
+    size_t size = 1;
+    while (size < capacity) size *= 2;
+    mask = size - 1;
+
+    slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; i++) {
+        slots[i].sequence.store(i, memory_order_relaxed);
+    }
+    applier = thread(&MutationQueue::run, this);
+}
+
+/*-----------------------------------------------------------------------
+    Apply every queued change, then stop the applier thread.
+
+    Postcondition: Every future and callback has been completed.
+-----------------------------------------------------------------------*/
+MutationQueue::~MutationQueue() {
+    stopping.store(true, memory_order_release);
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        signalled = true;
+    }
+    wakeup.notify_one();
+    applier.join();
+}
+
+/*-----------------------------------------------------------------------
+    Queue a change.
+
+    Postcondition: Returns a future holding true if the change was made.
+-----------------------------------------------------------------------*/
+future<bool> MutationQueue::submit(SocialGraph::Mutation mutation) {
+    promise<bool> result;
+    future<bool> outcome = result.get_future();
+    enqueue(mutation, &result, nullptr);
+    return outcome;
+}
+
+/*-----------------------------------------------------------------------
+    Queue a change with a completion callback.
+
+    Postcondition: onApplied runs on the applier thread once published.
+-----------------------------------------------------------------------*/
+void MutationQueue::submit(SocialGraph::Mutation mutation, function<void(bool)> onApplied) {
+    enqueue(mutation, nullptr, &onApplied);
+}
+
+/*-----------------------------------------------------------------------
+    Queue the SocialGraph operations of the same name.
+
+    Postcondition: The future holds true if the operation changed the graph.
+-----------------------------------------------------------------------*/
+future<bool> MutationQueue::addPerson(const string& name) {
+    return submit({ SocialGraph::Mutation::AddPerson, name, "" });
+}
+
+future<bool> MutationQueue::removePerson(const string& name) {
+    return submit({ SocialGraph::Mutation::RemovePerson, name, "" });
+}
+
+future<bool> MutationQueue::addFriend(const string& name1, const string& name2) {
+    return submit({ SocialGraph::Mutation::AddFriend, name1, name2 });
+}
+
+future<bool> MutationQueue::removeFriend(const string& name1, const string& name2) {
+    return submit({ SocialGraph::Mutation::RemoveFriend, name1, name2 });
+}
+
+/*-----------------------------------------------------------------------
+    Claim a slot, fill it and wake the applier if it sleeps.
+
+    Postcondition: The change is visible to the applier.
+-----------------------------------------------------------------------*/
+void MutationQueue::enqueue(SocialGraph::Mutation& mutation, promise<bool>* result,
+                            function<void(bool)>* onApplied) {
+    size_t position = tail.load(memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots[position & mask];
+        size_t sequence = slot->sequence.load(memory_order_acquire);
+        ptrdiff_t lag = (ptrdiff_t)(sequence - position);
+        if (lag == 0) {
+            // The slot is free for this position; try to claim it
+            if (tail.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+        }
+        else if (lag < 0) {
+            // Ring is full: the applier has not freed this slot yet
+            this_thread::yield();
+            position = tail.load(memory_order_relaxed);
+        }
+        else {
+            // Another producer claimed the position first
+            position = tail.load(memory_order_relaxed);
+        }
+    }
+
+    slot->mutation = move(mutation);
+    if (result != nullptr) slot->result = move(*result);
+    else slot->onApplied = move(*onApplied);
+    slot->sequence.store(position + 1, memory_order_release);
+
+    // Pairs with the fence in run(): either the applier sees the slot
+    // before it sleeps, or we see it sleeping and wake it
+    atomic_thread_fence(memory_order_seq_cst);
+    if (sleeping.load(memory_order_relaxed)) {
+        {
+            lock_guard<mutex> lock(wakeMutex);
+            signalled = true;
+        }
+        wakeup.notify_one();
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Check if the slot at head has been filled.
+
+    Postcondition: Returns true if the applier can take a change.
+-----------------------------------------------------------------------*/
+bool MutationQueue::hasWork() const {
+    return slots[head & mask].sequence.load(memory_order_acquire) == head + 1;
+}
+
+/*-----------------------------------------------------------------------
+    Body of the applier thread.
+
+    Postcondition: Every change queued before stopping was set has been
+                  applied and completed.
+-----------------------------------------------------------------------*/
+void MutationQueue::run() {
+    vector<SocialGraph::Mutation> batch;
+    vector<promise<bool>> results;
+    vector<function<void(bool)>> callbacks;
+
+    while (true) {
+        // Take up to maxBatch changes, freeing their slots right away
+        while (batch.size() < maxBatch && hasWork()) {
+            Slot& slot = slots[head & mask];
+            batch.push_back(move(slot.mutation));
+            callbacks.push_back(move(slot.onApplied));
+            slot.onApplied = nullptr;
+            results.push_back(move(slot.result));
+            slot.sequence.store(head + mask + 1, memory_order_release);
+            head++;
+        }
+
+        if (!batch.empty()) {
+            // One version for the whole batch
+            vector<bool> changed;
+            exception_ptr failure;
+            try {
+                changed = graph.applyBatch(batch);
+            }
+            catch (...) {
+                failure = current_exception();
+                changed.assign(batch.size(), false);
+            }
+
+            for (size_t i = 0; i < batch.size(); i++) {
+                if (callbacks[i]) callbacks[i](changed[i]);
+                else if (failure) results[i].set_exception(failure);
+                else results[i].set_value(changed[i]);
+            }
+            batch.clear();
+            results.clear();
+            callbacks.clear();
+            continue;
+        }
+
+        if (stopping.load(memory_order_acquire)) {
+            // Producers are done, but one may have filled a slot since
+            if (!hasWork()) return;
+            continue;
+        }
+
+        // Nothing queued: sleep until a producer signals
+        unique_lock<mutex> lock(wakeMutex);
+        sleeping.store(true, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!hasWork() && !stopping.load(memory_order_acquire)) {
+            wakeup.wait(lock, [this] { return signalled; });
+        }
+        signalled = false;
+        sleeping.store(false, memory_order_relaxed);
+    }
+}
@@ -0,0 +1,141 @@
+/******************************************************************************
+ * Class: MutationQueue
+ *
+ * Description: Asynchronous write path for a SocialGraph. Any number of
+ *              threads push changes onto a bounded, lock-free ring (one
+ *              compare-and-swap per change), and a single applier thread
+ *              drains it in batches. Each batch becomes one new version of
+ *              the graph, so readers see the changes of a batch together.
+ *              Producers learn the outcome of each change through a future
+ *              or a completion callback, run on the applier thread.
+ *
+ *              When the ring is full, producers wait for the applier to
+ *              free a slot. The applier sleeps on a condition variable
+ *              while the ring is empty; producers only touch its mutex to
+ *              wake it up.
+ *
+ * Member Variables:
+ *    - graph: Graph the changes are applied to
+ *    - slots: The ring; each slot carries a sequence number
+ *    - mask: Ring capacity minus one (the capacity is a power of two)
+ *    - maxBatch: Most changes applied as one version
+ *    - tail: Next position claimed by a producer
+ *    - head: Next position read by the applier
+ *    - stopping: Set when the queue is destroyed
+ *    - sleeping: True while the applier waits for work
+ *    - wakeMutex, wakeup, signalled: Wake-up handshake with the applier
+ *    - applier: The thread applying the changes
+ *
+ *****************************************************************************/
+
+#ifndef MUTATIONQUEUE_H
+#define MUTATIONQUEUE_H
+
+#include "SocialGraph.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+class MutationQueue {
+public:
+    /*** Constructer ***/
+    explicit MutationQueue(SocialGraph& graph, size_t capacity = 1024, size_t maxBatch = 256);
+    /*-------------------------------------------------------------------
+      Start the applier thread of a graph.
+
+      Precondition:  graph outlives the queue; capacity and maxBatch > 0.
+      Postcondition: The ring holds capacity changes, rounded up to a
+                     power of two.
+     ------------------------------------------------------------------*/
+
+    ~MutationQueue();
+    MutationQueue(const MutationQueue&) = delete;
+    MutationQueue& operator=(const MutationQueue&) = delete;
+    /*-------------------------------------------------------------------
+      Apply every queued change, then stop the applier thread.
+
+      Precondition:  No thread submits changes once destruction starts.
+     ------------------------------------------------------------------*/
+
+    /***** Producer Operations *****/
+    future<bool> submit(SocialGraph::Mutation mutation);
+    /*-------------------------------------------------------------------
+      Queue a change.
+
+      Postcondition: The future becomes ready once the change has been
+                     published, holding true if it changed the graph.
+     ------------------------------------------------------------------*/
+
+    void submit(SocialGraph::Mutation mutation, function<void(bool)> onApplied);
+    /*-------------------------------------------------------------------
+      Queue a change with a completion callback.
+
+      Precondition:  onApplied is cheap; it runs on the applier thread.
+      Postcondition: onApplied(changed) is called once the change has
+                     been published.
+     ------------------------------------------------------------------*/
+
+    future<bool> addPerson(const string& name);
+    future<bool> removePerson(const string& name);
+    future<bool> addFriend(const string& name1, const string& name2);
+    future<bool> removeFriend(const string& name1, const string& name2);
+    /*-------------------------------------------------------------------
+      Queue the SocialGraph operation of the same name.
+
+      Postcondition: The future holds true if the operation changed
+                     the graph.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Slot (one ring entry) *****/
+    struct alignas(64) Slot {
+        atomic<size_t> sequence;        // Position + 1 once filled; position + capacity once free
+        SocialGraph::Mutation mutation;
+        promise<bool> result;           // Used when onApplied is empty
+        function<void(bool)> onApplied;
+    };
+
+    /***** Data Members *****/
+    SocialGraph& graph;
+    unique_ptr<Slot[]> slots;
+    size_t mask;
+    size_t maxBatch;
+    alignas(64) atomic<size_t> tail;    // Shared by producers
+    alignas(64) size_t head;            // Only used by the applier
+    atomic<bool> stopping;
+    atomic<bool> sleeping;
+    mutex wakeMutex;
+    condition_variable wakeup;
+    bool signalled;                     // Guarded by wakeMutex
+    thread applier;                     // Started last
+
+    /***** Helper Functions *****/
+    void enqueue(SocialGraph::Mutation& mutation, promise<bool>* result, function<void(bool)>* onApplied);
+    /*-----------------------------------------------------------------------
+      Claim a slot, fill it and wake the applier if it sleeps.
+
+      Postcondition: Exactly one of result and onApplied is moved into the
+                     slot.
+     ----------------------------------------------------------------------*/
+
+    bool hasWork() const;
+    /*-----------------------------------------------------------------------
+      Check if the slot at head has been filled.
+     ----------------------------------------------------------------------*/
+
+    void run();
+    /*-----------------------------------------------------------------------
+      Body of the applier thread.
+
+      Postcondition: Returns once stopping is set and the ring is empty.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
@@ -0,0 +1,46 @@
+/*-------------------------------------------------------------------------
+  NameArena.cpp
+
+  - Implementation of all functions mentioned in NameArena.h
+------------------------------------------------------------------------*/
+#include "NameArena.h"
+#include <cstring>
+
+using namespace std;
+
+/*-----------------------------------------------------------------------
+    Copy a name into the arena.
+
+    Precondition:  name is the text to store.
+    Postcondition: Returns a view of the stored copy.
+-----------------------------------------------------------------------*/
+string_view NameArena::store(string_view name) {
+    if (name.empty()) return string_view();
+
+    char* destination;
+    if (name.size() > blockSize) {
+        // Oversized names get a block of their own, inserted before the
+        // current block so the free space at its end is not lost
+        unique_ptr<char[]> block(new char[name.size()]);
+        destination = block.get();
+        if (blocks.empty()) {
+            blocks.push_back(move(block));
+            used = blockSize;   // Force a fresh block for the next name
+        }
+        else {
+            blocks.insert(blocks.end() - 1, move(block));
+        }
+    }
+    else {
+        if (blocks.empty() || used + name.size() > blockSize) {
+            blocks.emplace_back(new char[blockSize]);
+            used = 0;
+        }
+        destination = blocks.back().get() + used;
+        used += name.size();
+    }
+
+    memcpy(destination, name.data(), name.size());
+    totalBytes += name.size();
+    return string_view(destination, name.size());
+}
@@ -0,0 +1,70 @@
+/******************************************************************************
+ * Class: NameArena
+ *
+ * Description: Append-only storage for person names. Names are copied into
+ *              large shared blocks instead of each owning a heap allocation,
+ *              and callers refer to them through string_views. A stored name
+ *              never moves and is never freed on its own, so its view stays
+ *              valid until the arena is destroyed. Versions of a graph share
+ *              one arena, which lives as long as the last of them.
+ *
+ * Member Variables:
+ *    - blocks: Memory blocks holding the names back to back
+ *    - blockSize: Size of a regular block in bytes
+ *    - used: Bytes taken in the last block
+ *    - totalBytes: Bytes taken by all stored names
+ *
+ *****************************************************************************/
+
+#ifndef NAMEARENA_H
+#define NAMEARENA_H
+
+#include <vector>
+#include <memory>
+#include <string_view>
+
+using namespace std;
+
+class NameArena {
+public:
+    /*** Constructer ***/
+    explicit NameArena(size_t blockSize = 64 * 1024) : blockSize(blockSize), used(0), totalBytes(0) {}
+    /*-------------------------------------------------------------------
+      Construct an empty arena.
+
+      Precondition:  blockSize is the size of each block to allocate.
+      Postcondition: An arena holding no names is created; no memory is
+                     allocated until the first name is stored.
+     ------------------------------------------------------------------*/
+
+    // Views point into the blocks, so the arena can move but not copy
+    NameArena(const NameArena&) = delete;
+    NameArena& operator=(const NameArena&) = delete;
+    NameArena(NameArena&&) = default;
+    NameArena& operator=(NameArena&&) = default;
+
+    string_view store(string_view name);
+    /*-------------------------------------------------------------------
+      Copy a name into the arena.
+
+      Precondition:  name is the text to store.
+      Postcondition: Returns a view of the stored copy. The view remains
+                     valid until the arena is destroyed.
+     ------------------------------------------------------------------*/
+
+    size_t bytesUsed() const { return totalBytes; }
+    /*-------------------------------------------------------------------
+      Get the number of bytes taken by stored names.
+
+      Postcondition: The total length of all stored names is returned.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    vector<unique_ptr<char[]>> blocks;  // Blocks in allocation order
+    size_t blockSize;                   // Size of a regular block
+    size_t used;                        // Bytes taken in blocks.back()
+    size_t totalBytes;                  // Bytes taken overall
+};
+
+#endif
@@ -0,0 +1,174 @@
+/*-------------------------------------------------------------------------
+  PageRank.cpp
+
+  - Implementation of the non-template functions mentioned in PageRank.h
+------------------------------------------------------------------------*/
+#include "PageRank.h"
+#include "ThreadBarrier.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace std;
+
+namespace {
+    // Fewer node IDs than this per thread are not worth a thread
+    const int MinNodesPerThread = 1024;
+
+    /***** Partial Sums (one thread's share of an iteration's totals) *****/
+    struct alignas(64) PartialSums {
+        double dangling = 0.0;      // Rank held by people without friends
+        double change = 0.0;        // Rank moved on the thread's range
+    };
+}
+
+/*-----------------------------------------------------------------------
+    Compute global PageRank.
+
+    Postcondition: Teleports go to every person alike.
+-----------------------------------------------------------------------*/
+PageRank::Result PageRank::ranks(const Options& options) const {
+    vector<double> teleport(nodeCount(), 0.0);
+    for (int id = 0; id < nodeCount(); id++) {
+        if (lists.isPerson(id)) teleport[id] = 1.0 / lists.people.size();
+    }
+    return run(teleport, options);
+}
+
+/*-----------------------------------------------------------------------
+    Compute PageRank personalized to a set of people.
+
+    Precondition:  seeds are node IDs of people.
+    Postcondition: Teleports go only to the seeds.
+-----------------------------------------------------------------------*/
+PageRank::Result PageRank::personalized(const vector<int>& seeds, const Options& options) const {
+    vector<double> teleport(nodeCount(), 0.0);
+    int weight = 0;
+    for (int seed : seeds) {
+        if (seed < 0 || seed >= nodeCount() || !lists.isPerson(seed)) continue;
+        teleport[seed] += 1.0;
+        weight++;
+    }
+    if (weight == 0) {
+        Result result;
+        result.ranks = teleport;
+        return result;
+    }
+    for (double& share : teleport) {
+        share /= weight;
+    }
+    return run(teleport, options);
+}
+
+/*-----------------------------------------------------------------------
+    Power iteration with a given teleport distribution.
+
+    Precondition:  teleport sums to 1 over living people.
+    Postcondition: Returns the ranks and the number of iterations run.
+-----------------------------------------------------------------------*/
+PageRank::Result PageRank::run(const vector<double>& teleport, const Options& options) const {
+    int count = nodeCount();
+    Result result;
+    result.ranks = teleport;
+    if (count == 0) {
+        result.converged = true;
+        return result;
+    }
+
+    int threadCount = options.threadCount;
+    if (threadCount <= 0) {
+        threadCount = max(1, (int)thread::hardware_concurrency());
+    }
+    threadCount = max(1, min(threadCount, count / MinNodesPerThread));
+
+    // Contiguous ranges of about the same number of people plus friendships
+    vector<int> bounds(threadCount + 1, count);
+    bounds[0] = 0;
+    size_t work = (size_t)count + lists.targets.size();
+    for (int t = 1; t < threadCount; t++) {
+        size_t goal = work * t / threadCount;
+        int low = bounds[t - 1], high = count;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if ((size_t)mid + lists.offsets[mid] < goal) low = mid + 1;
+            else high = mid;
+        }
+        bounds[t] = low;
+    }
+
+    double damping = options.damping;
+    vector<double>& rank = result.ranks;
+    vector<double> share(count, 0.0), next(count, 0.0);
+    vector<PartialSums> partials(threadCount);
+    double dangling = 0.0;
+    bool done = options.maxIterations <= 0;
+    ThreadBarrier barrier(threadCount);
+
+    auto worker = [&](int self) {
+        int begin = bounds[self], end = bounds[self + 1];
+        while (!done) {
+            // Publish what each person passes to each friend
+            double lost = 0.0;
+            for (int id = begin; id < end; id++) {
+                share[id] = rank[id] * invDegree[id];
+            }
+            for (int id = begin; id < end; id++) {
+                lost += invDegree[id] == 0.0 ? rank[id] : 0.0;
+            }
+            partials[self].dangling = lost;
+            barrier.arriveAndWait([&] {
+                dangling = 0.0;
+                for (const PartialSums& partial : partials) {
+                    dangling += partial.dangling;
+                }
+            });
+
+            // Pull the shares of the friends; the teleport and the rank of
+            // people without friends are spread by the teleport vector
+            double base = 1.0 - damping + damping * dangling;
+            for (int v = begin; v < end; v++) {
+                const int* friends = lists.targets.data() + lists.offsets[v];
+                int degree = lists.degree(v);
+                double sum0 = 0.0, sum1 = 0.0, sum2 = 0.0, sum3 = 0.0;
+                int i = 0;
+                for (; i + 4 <= degree; i += 4) {
+                    sum0 += share[friends[i]];
+                    sum1 += share[friends[i + 1]];
+                    sum2 += share[friends[i + 2]];
+                    sum3 += share[friends[i + 3]];
+                }
+                for (; i < degree; i++) {
+                    sum0 += share[friends[i]];
+                }
+                next[v] = base * teleport[v] + damping * ((sum0 + sum1) + (sum2 + sum3));
+            }
+            double moved = 0.0;
+            for (int v = begin; v < end; v++) {
+                moved += fabs(next[v] - rank[v]);
+            }
+            partials[self].change = moved;
+
+            barrier.arriveAndWait([&] {
+                double change = 0.0;
+                for (const PartialSums& partial : partials) {
+                    change += partial.change;
+                }
+                rank.swap(next);
+                result.iterations++;
+                result.change = change;
+                result.converged = change < options.tolerance;
+                done = result.converged || result.iterations >= options.maxIterations;
+            });
+        }
+    };
+
+    vector<thread> helpers;
+    for (int t = 1; t < threadCount; t++) {
+        helpers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (thread& helper : helpers) {
+        helper.join();
+    }
+    return result;
+}
@@ -0,0 +1,210 @@
+/******************************************************************************
+ * Class: PageRank
+ *
+ * Description: Influence scores by PageRank and personalized PageRank. The
+ *              friend lists are copied once into compressed sparse row form
+ *              so that any number of runs (one global ranking, many
+ *              personalized ones) share them.
+ *
+ *              Each power iteration is pull-based: every person first
+ *              publishes rank / degree in one contiguous array, then sums
+ *              the shares of their friends. A person's new rank is only
+ *              written by the thread that owns it, so no atomics or locks
+ *              are needed; threads own contiguous ranges balanced by friend
+ *              count and meet at a barrier twice per iteration. People with
+ *              no friends hand their rank back through the teleport vector.
+ *              The loops over the rank arrays are plain and contiguous so
+ *              the compiler can vectorize them, and the gather over a friend
+ *              list is split over four independent sums.
+ *
+ *              For a single person, forwardPush() approximates personalized
+ *              PageRank locally (Andersen, Chung and Lang): rank is pushed
+ *              out from the source only while some person holds more than
+ *              epsilon x degree of unspread rank. The work is bounded by
+ *              1 / (alpha x epsilon) pushes, whatever the size of the graph.
+ *
+ *              Ranks are taken over a FriendLists copy of the graph view;
+ *              removed node IDs get a rank of 0.
+ *
+ * Member Variables:
+ *    - lists: Friend lists of the graph view, shared by every run
+ *    - invDegree: 1 / number of friends, 0 for people without friends
+ *
+ *****************************************************************************/
+
+#ifndef PAGERANK_H
+#define PAGERANK_H
+
+#include "FriendLists.h"
+#include "TraversalWorkspace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class PageRank {
+public:
+    /***** Options Struct (controls of one run) *****/
+    struct Options {
+        double damping = 0.85;          // Chance of following a friendship
+        double tolerance = 1e-6;        // Stop once ranks move less than this in total
+        int maxIterations = 100;        // Stop after this many iterations regardless
+        int threadCount = 0;            // 0 uses one thread per hardware thread
+    };
+
+    /***** Result Struct (ranks and how they were reached) *****/
+    struct Result {
+        vector<double> ranks;           // Rank of each node ID, summing to 1
+        int iterations = 0;             // Power iterations run
+        double change = 0.0;            // Total rank moved by the last iteration
+        bool converged = false;         // change fell below the tolerance
+    };
+
+    /*** Constructer ***/
+    template <class Graph>
+    explicit PageRank(const Graph& graph) : lists(graph), invDegree(lists.nodeCount(), 0.0) {
+        for (int id = 0; id < nodeCount(); id++) {
+            if (lists.degree(id) > 0) invDegree[id] = 1.0 / lists.degree(id);
+        }
+    }
+    /*-------------------------------------------------------------------
+      Prepare to rank the people of a graph view.
+
+      Postcondition: The friend lists and inverse degrees are computed
+                     once, for every later call of ranks() or
+                     personalized().
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return lists.nodeCount(); }
+    /*-------------------------------------------------------------------
+      Get the size of the node ID space.
+     ------------------------------------------------------------------*/
+
+    /*** Ranking **/
+    Result ranks() const { return ranks(Options()); }
+    Result ranks(const Options& options) const;
+    /*-------------------------------------------------------------------
+      Compute global PageRank.
+
+      Postcondition: Teleports go to every person alike. ranks[id] is the
+                     rank of node ID id.
+     ------------------------------------------------------------------*/
+
+    Result personalized(const vector<int>& seeds) const { return personalized(seeds, Options()); }
+    Result personalized(const vector<int>& seeds, const Options& options) const;
+    /*-------------------------------------------------------------------
+      Compute PageRank personalized to a set of people.
+
+      Precondition:  seeds are node IDs of people; repeats weigh more.
+      Postcondition: Teleports go only to the seeds, so ranks measure
+                     closeness to them. Returns all zeros if no seed is a
+                     person.
+     ------------------------------------------------------------------*/
+
+    template <class Graph>
+    static vector<pair<int, double>> forwardPush(const Graph& graph, int source, double epsilon,
+                                                 double alpha = 0.15,
+                                                 chrono::steady_clock::time_point deadline =
+                                                     chrono::steady_clock::time_point::max());
+    /*-------------------------------------------------------------------
+      Approximate the personalized PageRank of one person by local pushes.
+
+      Precondition:  source is a node ID below graph.nodeCount();
+                     0 < alpha < 1 is the chance of restarting at source;
+                     epsilon > 0.
+      Postcondition: Returns (node ID, estimate) pairs with a positive
+                     estimate, highest first. Each estimate is below the
+                     true rank by less than epsilon x degree. The pushes
+                     stop early, with coarser estimates, once deadline
+                     has passed.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    FriendLists lists;              // Copy of the graph view
+    vector<double> invDegree;       // 1 / degree of each node ID
+
+    /***** Helper Functions *****/
+    Result run(const vector<double>& teleport, const Options& options) const;
+    /*-----------------------------------------------------------------------
+      Power iteration with a given teleport distribution.
+
+      Precondition:  teleport sums to 1 over living people.
+      Postcondition: Returns the ranks once they converge or the iteration
+                     limit is reached.
+     ----------------------------------------------------------------------*/
+};
+
+/*-----------------------------------------------------------------------
+    Approximate the personalized PageRank of one person by local pushes.
+
+    Postcondition: Returns the estimates of the people reached, highest
+                  first.
+-----------------------------------------------------------------------*/
+template <class Graph>
+vector<pair<int, double>> PageRank::forwardPush(const Graph& graph, int source, double epsilon,
+                                                double alpha, chrono::steady_clock::time_point deadline) {
+    // Only the people reached get a slot: the workspace parent field maps
+    // a node ID to its slot, and the distance field is 1 while queued
+    TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(graph.nodeCount());
+    vector<int> nodes;
+    vector<double> estimate, residual;
+    auto slotOf = [&](int id) {
+        if (!ws->visited(id)) {
+            ws->visit(id, (int)nodes.size(), 0);
+            nodes.push_back(id);
+            estimate.push_back(0.0);
+            residual.push_back(0.0);
+        }
+        return ws->parent(id);
+    };
+
+    vector<int>& q = ws->queue();
+    residual[slotOf(source)] = 1.0;
+    ws->visit(source, 0, 1);
+    q.push_back(source);
+
+    for (size_t head = 0; head < q.size(); head++) {
+        // Reading the clock on every push would cost more than the push
+        if ((head & 255) == 255 && chrono::steady_clock::now() >= deadline) break;
+
+        int u = q[head];
+        int slot = ws->parent(u);
+        ws->visit(u, slot, 0);
+        double rest = residual[slot];
+        int degree = graph.neighbors(u).size();
+        residual[slot] = 0.0;
+        if (degree == 0) {
+            // Nowhere to spread to; the walk only ever restarts here
+            estimate[slot] += rest;
+            continue;
+        }
+
+        estimate[slot] += alpha * rest;
+        double spread = (1.0 - alpha) * rest / degree;
+        for (int v : graph.neighbors(u)) {
+            int target = slotOf(v);
+            residual[target] += spread;
+            if (ws->distance(v) == 0 && residual[target] >= epsilon * graph.neighbors(v).size()) {
+                ws->visit(v, target, 1);
+                q.push_back(v);
+            }
+        }
+    }
+
+    vector<pair<int, double>> ranked;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (estimate[i] > 0.0) ranked.emplace_back(nodes[i], estimate[i]);
+    }
+    sort(ranked.begin(), ranked.end(), [](const pair<int, double>& a, const pair<int, double>& b) {
+        if (a.second != b.second) return a.second > b.second;
+        return a.first < b.first;
+    });
+    return ranked;
+}
+
+#endif
@@ -0,0 +1,186 @@
+/******************************************************************************
+ * Class: ParallelBFS
+ *
+ * Description: Level-synchronous breadth-first search run by several
+ *              threads. Each thread keeps its own slice of the frontier and
+ *              hands out work from it in small chunks; a thread whose slice
+ *              runs dry steals chunks from the slices of the others, so one
+ *              high-degree region does not leave the rest of the threads
+ *              idle. Nodes are claimed with an atomic test-and-set on a
+ *              visited bitmap, which makes every node enter the next
+ *              frontier exactly once.
+ *
+ *              Works on any graph view offering nodeCount() and
+ *              neighbors(id) (SocialGraph::Snapshot and GraphSnapshot). Both
+ *              are immutable, so the threads share the view without locks.
+ *
+ *****************************************************************************/
+
+#ifndef PARALLELBFS_H
+#define PARALLELBFS_H
+
+#include "ThreadBarrier.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class ParallelBFS {
+public:
+    template <class Graph>
+    static vector<int> distances(const Graph& graph, int source, int threadCount = 0) {
+        vector<int> distance(graph.nodeCount(), -1);
+        run(graph, source, -1, nullptr, distance, nullptr, threadCount);
+        return distance;
+    }
+    /*-------------------------------------------------------------------
+      Compute the hop distance from one node to every node.
+
+      Precondition:  source is a node ID of graph. threadCount of 0 uses
+                     one thread per hardware thread.
+      Postcondition: Element i is the distance from source to node i, or
+                     -1 if node i can't be reached.
+     ------------------------------------------------------------------*/
+
+    template <class Graph>
+    static vector<int> path(const Graph& graph, int source, int target,
+                            const vector<int>& blocked = vector<int>(), int threadCount = 0) {
+        int count = graph.nodeCount();
+        vector<int> distance(count, -1);
+        vector<int> parent(count, -1);
+        vector<int> result;
+        if (!run(graph, source, target, &blocked, distance, &parent, threadCount)) {
+            return result;
+        }
+
+        for (int v = target; v != -1; v = parent[v]) {
+            result.push_back(v);
+        }
+        reverse(result.begin(), result.end());
+        return result;
+    }
+    /*-------------------------------------------------------------------
+      Find a shortest path between two nodes.
+
+      Precondition:  source and target are node IDs of graph; blocked
+                     lists node IDs the path must not go through.
+      Postcondition: Returns the node IDs of one shortest path, from
+                     source to target, or an empty vector if there is
+                     none. The search stops at the level of target.
+     ------------------------------------------------------------------*/
+
+private:
+    static const int ChunkSize = 64;    // Nodes handed out per grab
+
+    /***** Frontier (one thread's slice of the current and next level) *****/
+    struct alignas(64) Frontier {
+        vector<int> current;            // Nodes of this level owned by the thread
+        vector<int> next;               // Nodes claimed by the thread for the next level
+        atomic<size_t> cursor{0};       // Next unclaimed position in current
+    };
+
+    /***** Helper Functions *****/
+    static bool claim(vector<atomic<uint64_t>>& visited, int id) {
+        uint64_t bit = uint64_t(1) << (id & 63);
+        atomic<uint64_t>& word = visited[id >> 6];
+        // Plain load first; most neighbors are already visited
+        if (word.load(memory_order_relaxed) & bit) return false;
+        return (word.fetch_or(bit, memory_order_relaxed) & bit) == 0;
+    }
+    /*-----------------------------------------------------------------------
+      Atomically mark a node visited.
+
+      Postcondition: Returns true for exactly one caller per node.
+     ----------------------------------------------------------------------*/
+
+    template <class Graph>
+    static bool run(const Graph& graph, int source, int target, const vector<int>* blocked,
+                    vector<int>& distance, vector<int>* parent, int threadCount) {
+        int count = graph.nodeCount();
+        if (threadCount <= 0) {
+            threadCount = max(1, (int)thread::hardware_concurrency());
+        }
+        // A thread needs a few chunks of work per level to be worth it
+        threadCount = max(1, min(threadCount, count / (ChunkSize * 4)));
+
+        vector<atomic<uint64_t>> visited((count + 63) / 64);
+        if (blocked != nullptr) {
+            for (int id : *blocked) {
+                if (id >= 0 && id < count) claim(visited, id);
+            }
+        }
+        claim(visited, source);     // The source counts even if blocked
+        distance[source] = 0;
+
+        unique_ptr<Frontier[]> frontiers(new Frontier[threadCount]);
+        frontiers[0].current.push_back(source);
+        ThreadBarrier barrier(threadCount);   // One phase per level
+        atomic<bool> found(source == target);
+        bool done = found.load();
+        int level = 0;
+
+        auto worker = [&](int self) {
+            while (!done) {
+                // Own slice first, then steal from the others in turn
+                for (int offset = 0; offset < threadCount && !found.load(memory_order_relaxed); offset++) {
+                    Frontier& victim = frontiers[(self + offset) % threadCount];
+                    size_t size = victim.current.size();
+                    while (!found.load(memory_order_relaxed)) {
+                        size_t first = victim.cursor.fetch_add(ChunkSize, memory_order_relaxed);
+                        if (first >= size) break;
+                        size_t last = min(first + ChunkSize, size);
+                        for (size_t i = first; i < last; i++) {
+                            int v = victim.current[i];
+                            for (int w : graph.neighbors(v)) {
+                                if (!claim(visited, w)) continue;
+                                distance[w] = level + 1;
+                                if (parent != nullptr) (*parent)[w] = v;
+                                frontiers[self].next.push_back(w);
+                                if (w == target) found.store(true, memory_order_relaxed);
+                            }
+                        }
+                    }
+                }
+
+                barrier.arriveAndWait([&] {
+                    size_t total = 0;
+                    for (int t = 0; t < threadCount; t++) {
+                        Frontier& frontier = frontiers[t];
+                        frontier.current.swap(frontier.next);
+                        frontier.next.clear();
+                        frontier.cursor.store(0, memory_order_relaxed);
+                        total += frontier.current.size();
+                    }
+                    level++;
+                    done = total == 0 || found.load(memory_order_relaxed);
+                });
+            }
+        };
+
+        vector<thread> helpers;
+        for (int t = 1; t < threadCount; t++) {
+            helpers.emplace_back(worker, t);
+        }
+        worker(0);
+        for (thread& helper : helpers) {
+            helper.join();
+        }
+        return target == -1 || found.load();
+    }
+    /*-----------------------------------------------------------------------
+      Run the search.
+
+      Precondition:  distance holds graph.nodeCount() entries of -1, and so
+                     does parent unless it is null. target is -1 to visit
+                     every reachable node.
+      Postcondition: distance (and parent) are filled in for every node
+                     reached. Returns true if target was reached, or if
+                     target is -1.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
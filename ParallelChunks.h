@@ -0,0 +1,68 @@
+/******************************************************************************
+ * Class: ParallelChunks
+ *
+ * Description: Splits a range of node IDs over a group of threads in small
+ *              chunks that each thread claims when it runs out of work. The
+ *              cost per person in graph algorithms is very uneven, so
+ *              claiming on demand keeps every thread busy where fixed ranges
+ *              would leave some idle. The calling thread works too.
+ *
+ *****************************************************************************/
+
+#ifndef PARALLELCHUNKS_H
+#define PARALLELCHUNKS_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class ParallelChunks {
+public:
+    static const int DefaultChunk = 64;     // Node IDs claimed at a time
+
+    static int threadsFor(int count, int threadCount, int chunkSize = DefaultChunk) {
+        if (threadCount <= 0) {
+            threadCount = max(1, (int)thread::hardware_concurrency());
+        }
+        return max(1, min(threadCount, (count + chunkSize - 1) / chunkSize));
+    }
+    /*-------------------------------------------------------------------
+      Pick the number of threads for a range.
+
+      Precondition:  threadCount of 0 asks for one per hardware thread.
+      Postcondition: Returns at least 1 and never more threads than chunks.
+     ------------------------------------------------------------------*/
+
+    template <class Work>
+    static void run(int count, int threadCount, Work work, int chunkSize = DefaultChunk) {
+        atomic<int> cursor(0);
+        auto worker = [&](int self) {
+            for (int start = cursor.fetch_add(chunkSize); start < count; start = cursor.fetch_add(chunkSize)) {
+                work(self, start, min(count, start + chunkSize));
+            }
+        };
+
+        vector<thread> helpers;
+        for (int t = 1; t < threadCount; t++) {
+            helpers.emplace_back(worker, t);
+        }
+        worker(0);
+        for (thread& helper : helpers) {
+            helper.join();
+        }
+    }
+    /*-------------------------------------------------------------------
+      Run work over [0, count) on threadCount threads.
+
+      Precondition:  work can be called as work(int thread, int start,
+                     int end); thread is in [0, threadCount) and can index
+                     per-thread scratch space.
+      Postcondition: Every chunk was handed to work exactly once and all
+                     threads have finished.
+     ------------------------------------------------------------------*/
+};
+
+#endif
@@ -0,0 +1,253 @@
+/******************************************************************************
+ * Class: PathEnumerator
+ *
+ * Description: Counts and lists alternative routes between two people.
+ *              One BFS from the target gives every person's distance to it,
+ *              and the edges that step one hop closer form the DAG of all
+ *              shortest paths. The number of shortest paths is summed over
+ *              that DAG level by level, and the shortest paths themselves
+ *              are read off it by a depth-first walk.
+ *
+ *              When fewer than k shortest paths exist, the remaining ones
+ *              come from Yen's algorithm: every accepted path is cut at each
+ *              of its nodes, and a BFS from there (avoiding the part before
+ *              the cut and the next hops already used by accepted paths with
+ *              the same start) proposes a new, loopless candidate. The
+ *              shortest candidate is accepted next.
+ *
+ *              Works on any graph view offering nodeCount() and
+ *              neighbors(id) (SocialGraph::Snapshot and GraphSnapshot).
+ *
+ *****************************************************************************/
+
+#ifndef PATHENUMERATOR_H
+#define PATHENUMERATOR_H
+
+#include "TraversalWorkspace.h"
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class PathEnumerator {
+public:
+    template <class Graph>
+    static uint64_t countShortest(const Graph& graph, int from, int to) {
+        TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(graph.nodeCount());
+        vector<uint64_t> counts;
+        if (!buildDag(graph, to, from, *ws, &counts)) return 0;
+        return counts[ws->parent(from)];
+    }
+    /*-------------------------------------------------------------------
+      Count the shortest paths between two people.
+
+      Precondition:  from and to are node IDs below graph.nodeCount().
+      Postcondition: Returns the number of distinct shortest paths, 0 if
+                     to can't be reached, saturating at UINT64_MAX. Only
+                     people closer to to than from is are visited.
+     ------------------------------------------------------------------*/
+
+    template <class Graph>
+    static vector<vector<int>> kShortest(const Graph& graph, int from, int to, int k);
+    /*-------------------------------------------------------------------
+      List up to k distinct loopless paths, shortest first.
+
+      Precondition:  from and to are node IDs below graph.nodeCount().
+      Postcondition: Returns at most k paths of node IDs from from to to,
+                     in order of length. Every shortest path comes before
+                     any longer one. Shortest paths follow the order of the
+                     friend lists; longer paths of equal length come in
+                     lexicographic order of their node IDs.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Helper Functions *****/
+    template <class Graph>
+    static bool buildDag(const Graph& graph, int target, int source,
+                         TraversalWorkspace& ws, vector<uint64_t>* counts);
+    /*-----------------------------------------------------------------------
+      BFS from target until source is reached.
+
+      Postcondition: Returns true if source was reached. Every person at
+                     most as far from target as source has their distance
+                     to target; the parent slot holds their position in
+                     the queue, and counts (if given) the number of
+                     shortest paths to target at that position.
+     ----------------------------------------------------------------------*/
+
+    template <class Graph>
+    static void addSpurs(const Graph& graph, const vector<vector<int>>& accepted, size_t index,
+                         set<vector<int>>& known, set<pair<size_t, vector<int>>>& candidates);
+    /*-----------------------------------------------------------------------
+      Propose the Yen candidates that branch off one accepted path.
+
+      Postcondition: Every new candidate is added to known and, keyed by
+                     its length, to candidates.
+     ----------------------------------------------------------------------*/
+};
+
+/*-----------------------------------------------------------------------
+    List up to k distinct loopless paths, shortest first.
+
+    Postcondition: Returns the paths in order of length. The shortest come
+                  from a DFS of the shortest-path DAG, the longer ones
+                  from Yen's candidate set, ordered by length and then by
+                  node IDs.
+-----------------------------------------------------------------------*/
+template <class Graph>
+vector<vector<int>> PathEnumerator::kShortest(const Graph& graph, int from, int to, int k) {
+    vector<vector<int>> accepted;
+    if (k <= 0) return accepted;
+
+    {
+        TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(graph.nodeCount());
+        if (!buildDag(graph, to, from, *ws, nullptr)) return accepted;
+
+        // Depth-first walk of the DAG; every step moves one hop closer
+        vector<int> path(1, from);
+        vector<int> tried(1, 0);    // Friends tried so far at each depth
+        while (!path.empty() && (int)accepted.size() < k) {
+            int v = path.back();
+            if (v == to) {
+                accepted.push_back(path);
+                path.pop_back();
+                tried.pop_back();
+                continue;
+            }
+
+            auto friends = graph.neighbors(v);
+            int closer = ws->distance(v) - 1;
+            int i = tried.back();
+            while (i < (int)friends.size() &&
+                   !(ws->visited(friends[i]) && ws->distance(friends[i]) == closer)) {
+                i++;
+            }
+            if (i == (int)friends.size()) {
+                path.pop_back();
+                tried.pop_back();
+                continue;
+            }
+            tried.back() = i + 1;
+            path.push_back(friends[i]);
+            tried.push_back(0);
+        }
+    }
+
+    // Fewer shortest paths than asked for: all of them are accepted, so
+    // Yen's candidates are the longer paths
+    set<vector<int>> known(accepted.begin(), accepted.end());
+    set<pair<size_t, vector<int>>> candidates;
+    size_t expanded = 0;
+    while ((int)accepted.size() < k) {
+        for (; expanded < accepted.size(); expanded++) {
+            addSpurs(graph, accepted, expanded, known, candidates);
+        }
+        if (candidates.empty()) break;
+        accepted.push_back(candidates.begin()->second);
+        candidates.erase(candidates.begin());
+    }
+    return accepted;
+}
+
+/*-----------------------------------------------------------------------
+    BFS from target until source is reached.
+
+    Postcondition: Returns true if source was reached.
+-----------------------------------------------------------------------*/
+template <class Graph>
+bool PathEnumerator::buildDag(const Graph& graph, int target, int source,
+                              TraversalWorkspace& ws, vector<uint64_t>* counts) {
+    vector<int>& q = ws.queue();
+    ws.visit(target, 0, 0);
+    q.push_back(target);
+    if (counts) counts->assign(1, 1);
+
+    for (size_t head = 0; head < q.size(); head++) {
+        int v = q[head];
+        // Every person one hop closer was dequeued before, so the count
+        // of source is final
+        if (v == source) return true;
+
+        int next = ws.distance(v) + 1;
+        for (int w : graph.neighbors(v)) {
+            if (!ws.visited(w)) {
+                ws.visit(w, (int)q.size(), next);
+                q.push_back(w);
+                if (counts) counts->push_back(0);
+            }
+            else if (ws.distance(w) != next) {
+                continue;
+            }
+            if (counts) {
+                uint64_t add = (*counts)[head];
+                uint64_t& count = (*counts)[ws.parent(w)];
+                count = count > UINT64_MAX - add ? UINT64_MAX : count + add;
+            }
+        }
+    }
+    return false;
+}
+
+/*-----------------------------------------------------------------------
+    Propose the Yen candidates that branch off one accepted path.
+
+    Postcondition: New candidates are added to known and candidates.
+-----------------------------------------------------------------------*/
+template <class Graph>
+void PathEnumerator::addSpurs(const Graph& graph, const vector<vector<int>>& accepted, size_t index,
+                              set<vector<int>>& known, set<pair<size_t, vector<int>>>& candidates) {
+    const vector<int>& path = accepted[index];
+    int target = path.back();
+    for (size_t i = 0; i + 1 < path.size(); i++) {
+        int spur = path[i];
+
+        // The candidate keeps path[0..i] and must leave spur by a friend
+        // that no accepted path with the same start took
+        vector<int> usedHops;
+        for (const vector<int>& other : accepted) {
+            if (other.size() > i + 1 && equal(path.begin(), path.begin() + i + 1, other.begin())) {
+                usedHops.push_back(other[i + 1]);
+            }
+        }
+
+        // Nodes before the spur are blocked, which keeps the path loopless
+        TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(graph.nodeCount());
+        for (size_t r = 0; r < i; r++) {
+            ws->block(path[r]);
+        }
+        ws->visit(spur, -1, 0);
+        vector<int>& q = ws->queue();
+        q.push_back(spur);
+
+        bool found = false;
+        for (size_t head = 0; head < q.size() && !found; head++) {
+            int v = q[head];
+            for (int w : graph.neighbors(v)) {
+                if (ws->visited(w)) continue;
+                if (v == spur && find(usedHops.begin(), usedHops.end(), w) != usedHops.end()) continue;
+                ws->visit(w, v, ws->distance(v) + 1);
+                q.push_back(w);
+                if (w == target) {
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (!found) continue;
+
+        vector<int> candidate(path.begin(), path.begin() + i);
+        size_t rootLength = candidate.size();
+        for (int v = target; v != -1; v = ws->parent(v)) {
+            candidate.push_back(v);
+        }
+        reverse(candidate.begin() + rootLength, candidate.end());
+        if (known.insert(candidate).second) {
+            candidates.emplace(candidate.size(), candidate);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,188 @@
+/******************************************************************************
+ * Class: PersistentArray
+ *
+ * Description: Array with cheap copies, stored as a 32-way tree. Copying the
+ *              array only copies the root pointer, and changing an element
+ *              copies the O(log32 n) nodes on the path to it, so every copy
+ *              keeps sharing the untouched parts of the tree.
+ *
+ *              Writers pass an edit token to assign() and append(). Nodes
+ *              created under the current token are still private to the
+ *              writer and are changed in place; nodes from any other token
+ *              are copied first. A token must never be reused once a copy of
+ *              the array has been handed to readers.
+ *
+ * Member Variables:
+ *    - root: Top node of the tree (null while the array is empty)
+ *    - shift: Bits of the index consumed above the leaves
+ *    - count: Number of elements
+ *
+ *****************************************************************************/
+
+#ifndef PERSISTENTARRAY_H
+#define PERSISTENTARRAY_H
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <cstdint>
+
+using namespace std;
+
+template <class T>
+class PersistentArray {
+public:
+    /*** Constructer ***/
+    PersistentArray() : shift(0), count(0) {}
+    /*-------------------------------------------------------------------
+      Construct an empty array.
+
+      Postcondition: size() is 0.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int size() const { return count; }
+    /*-------------------------------------------------------------------
+      Get the number of elements.
+     ------------------------------------------------------------------*/
+
+    const T& operator[](int i) const {
+        const Node* node = root.get();
+        for (int level = shift; level > 0; level -= Bits) {
+            node = node->children[(i >> level) & Mask].get();
+        }
+        return node->items[i & Mask];
+    }
+    /*-------------------------------------------------------------------
+      Read one element.
+
+      Precondition:  0 <= i < size().
+      Postcondition: Returns the element in O(log32 n).
+     ------------------------------------------------------------------*/
+
+    template <class Visitor>
+    void forEach(Visitor visit) const {
+        if (root) visitNode(root.get(), shift, 0, visit);
+    }
+    /*-------------------------------------------------------------------
+      Visit every element in index order.
+
+      Precondition:  visit can be called as visit(int index, const T&).
+      Postcondition: visit is called once per element, walking each leaf
+                     only once.
+     ------------------------------------------------------------------*/
+
+    /*** Setters **/
+    void assign(int i, T value, uint64_t token) {
+        root = assignPath(root, shift, i, value, token);
+    }
+    /*-------------------------------------------------------------------
+      Replace one element.
+
+      Precondition:  0 <= i < size(); token identifies the current writer.
+      Postcondition: Element i is value. Copies of this array made before
+                     the call, under another token, are unaffected.
+     ------------------------------------------------------------------*/
+
+    void append(T value, uint64_t token) {
+        // Grow a level when the tree is full
+        if (root && count == (1 << (shift + Bits))) {
+            shared_ptr<Node> top = make_shared<Node>();
+            top->owner = token;
+            top->children[0] = root;
+            root = top;
+            shift += Bits;
+        }
+        count++;
+        root = assignPath(root, shift, count - 1, value, token);
+    }
+    /*-------------------------------------------------------------------
+      Add an element at the end.
+
+      Precondition:  token identifies the current writer.
+      Postcondition: size() grows by one and the last element is value.
+     ------------------------------------------------------------------*/
+
+    void removeLast(uint64_t token) {
+        // Clear the slot so the array stops holding on to the element
+        T empty = T();
+        root = assignPath(root, shift, count - 1, empty, token);
+        count--;
+    }
+    /*-------------------------------------------------------------------
+      Drop the last element.
+
+      Precondition:  size() > 0; token identifies the current writer.
+      Postcondition: size() shrinks by one. The tree keeps its height.
+     ------------------------------------------------------------------*/
+
+private:
+    static const int Bits = 5;
+    static const int Width = 1 << Bits;
+    static const int Mask = Width - 1;
+
+    /***** Tree Node *****/
+    struct Node {
+        uint64_t owner = 0;                             // Token that may edit in place
+        array<shared_ptr<const Node>, Width> children;  // Used above the leaves
+        array<T, Width> items;                          // Used in the leaves
+    };
+
+    /***** Data Members *****/
+    shared_ptr<const Node> root;    // Top of the tree
+    int shift;                      // 0 when root is a leaf
+    int count;                      // Number of elements
+
+    /***** Helper Functions *****/
+    static shared_ptr<const Node> assignPath(const shared_ptr<const Node>& node, int level,
+                                             int i, T& value, uint64_t token) {
+        shared_ptr<Node> editable;
+        if (node && node->owner == token) {
+            // Created by this writer and not yet visible to any reader
+            editable = const_pointer_cast<Node>(node);
+        }
+        else {
+            editable = node ? make_shared<Node>(*node) : make_shared<Node>();
+            editable->owner = token;
+        }
+
+        if (level == 0) {
+            editable->items[i & Mask] = move(value);
+        }
+        else {
+            shared_ptr<const Node>& child = editable->children[(i >> level) & Mask];
+            child = assignPath(child, level - Bits, i, value, token);
+        }
+        return editable;
+    }
+    /*-----------------------------------------------------------------------
+      Copy (or edit in place) the path from node down to element i.
+
+      Precondition:  level is the shift of node in the tree.
+      Postcondition: Returns the new node for this level of the path.
+     ----------------------------------------------------------------------*/
+
+    template <class Visitor>
+    void visitNode(const Node* node, int level, int first, Visitor& visit) const {
+        if (level == 0) {
+            int last = min(first + Width, count);
+            for (int i = first; i < last; i++) {
+                visit(i, node->items[i & Mask]);
+            }
+            return;
+        }
+        for (int c = 0; c < Width; c++) {
+            int childFirst = first + (c << level);
+            if (childFirst >= count) break;
+            visitNode(node->children[c].get(), level - Bits, childFirst, visit);
+        }
+    }
+    /*-----------------------------------------------------------------------
+      Visit the elements under node.
+
+      Precondition:  first is the index of the first element under node.
+      Postcondition: visit is called for each element under node.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
@@ -0,0 +1,309 @@
+/*-------------------------------------------------------------------------
+  PrunedLabelIndex.cpp
+
+  - Implementation of the non-template functions mentioned in PrunedLabelIndex.h
+------------------------------------------------------------------------*/
+#include "PrunedLabelIndex.h"
+#include "ThreadBarrier.h"
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+namespace {
+    // Hubs processed one at a time before the parallel rounds start; they
+    // cover most pairs, so their pruning should not be weakened
+    const int SequentialHubs = 256;
+
+    // Largest distance a label entry can hold
+    const int MaxDistance = 65535;
+
+    // Written first in a saved index ("PLL1")
+    const uint32_t FileMagic = 0x314C4C50;
+
+    /***** Label Entry (one hub of one person, while building) *****/
+    struct LabelEntry {
+        int hub;                // Rank of the hub
+        uint16_t distance;      // Hops to the hub
+    };
+
+    /***** Search State (scratch arrays of one building thread) *****/
+    struct SearchState {
+        vector<int> distance;                       // -1 when not visited
+        vector<int> rootDistance;                   // Root's distance to each hub rank
+        vector<int> queue;
+        vector<pair<int, LabelEntry>> added;        // (person, entry) found this round
+        bool tooFar = false;                        // A distance did not fit
+    };
+}
+
+/*-----------------------------------------------------------------------
+    Build the labels of a graph given by its friend lists.
+
+    Postcondition: offsets, hubs and hubDistances hold the labels.
+-----------------------------------------------------------------------*/
+void PrunedLabelIndex::build(const FriendLists& adjacency, int threadCount) {
+    int count = adjacency.nodeCount();
+    if (threadCount <= 0) {
+        threadCount = max(1, (int)thread::hardware_concurrency());
+    }
+    threadCount = max(1, min(threadCount, count));
+
+    // Hub rank 0 is the best-connected person
+    vector<int> order(count);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&adjacency](int a, int b) {
+        return adjacency.degree(a) > adjacency.degree(b);
+    });
+
+    vector<vector<LabelEntry>> labels(count);
+    vector<SearchState> states(threadCount);
+    for (SearchState& state : states) {
+        state.distance.assign(count, -1);
+        state.rootDistance.assign(count, MaxDistance * 2 + 1);
+    }
+
+    // Pruned BFS from the person of one rank. Reads only the labels of
+    // earlier rounds; new entries wait in state.added.
+    auto search = [&](SearchState& state, int rank) {
+        int root = order[rank];
+        for (const LabelEntry& entry : labels[root]) {
+            state.rootDistance[entry.hub] = entry.distance;
+        }
+
+        state.queue.push_back(root);
+        state.distance[root] = 0;
+        for (size_t head = 0; head < state.queue.size(); head++) {
+            int u = state.queue[head];
+            int d = state.distance[u];
+
+            // Stop here if an earlier hub already gives distance d
+            bool covered = false;
+            for (const LabelEntry& entry : labels[u]) {
+                if (state.rootDistance[entry.hub] + entry.distance <= d) {
+                    covered = true;
+                    break;
+                }
+            }
+            if (covered) continue;
+            if (d > MaxDistance) {
+                state.tooFar = true;
+                break;
+            }
+
+            state.added.push_back(make_pair(u, LabelEntry{ rank, (uint16_t)d }));
+            for (int i = adjacency.offsets[u]; i < adjacency.offsets[u + 1]; i++) {
+                int w = adjacency.targets[i];
+                if (state.distance[w] == -1) {
+                    state.distance[w] = d + 1;
+                    state.queue.push_back(w);
+                }
+            }
+        }
+
+        for (int u : state.queue) {
+            state.distance[u] = -1;
+        }
+        state.queue.clear();
+        for (const LabelEntry& entry : labels[root]) {
+            state.rootDistance[entry.hub] = MaxDistance * 2 + 1;
+        }
+    };
+
+    int roundStart = 0;
+    int roundSize = 1;
+    bool done = count == 0;
+    ThreadBarrier barrier(threadCount);     // One phase per round
+
+    auto worker = [&](int self) {
+        while (!done) {
+            if (self < roundSize && roundStart + self < count) {
+                search(states[self], roundStart + self);
+            }
+            barrier.arriveAndWait([&] {
+                // Thread t searched rank roundStart + t, so appending in
+                // thread order keeps every label sorted by hub rank
+                for (SearchState& state : states) {
+                    for (const pair<int, LabelEntry>& added : state.added) {
+                        labels[added.first].push_back(added.second);
+                    }
+                    state.added.clear();
+                }
+                roundStart += roundSize;
+                roundSize = roundStart < SequentialHubs ? 1 : threadCount;
+                done = roundStart >= count;
+            });
+        }
+    };
+
+    vector<thread> helpers;
+    for (int t = 1; t < threadCount; t++) {
+        helpers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (thread& helper : helpers) {
+        helper.join();
+    }
+    for (const SearchState& state : states) {
+        if (state.tooFar) throw length_error("PrunedLabelIndex: distance too large for a label");
+    }
+
+    // Flatten the labels
+    offsets.assign(1, 0);
+    hubs.clear();
+    hubDistances.clear();
+    for (int id = 0; id < count; id++) {
+        for (const LabelEntry& entry : labels[id]) {
+            hubs.push_back(entry.hub);
+            hubDistances.push_back(entry.distance);
+        }
+        offsets.push_back((int)hubs.size());
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Get the exact hop distance between two people.
+
+    Precondition:  a and b are node IDs below nodeCount().
+    Postcondition: Returns the distance, or -1 if they are not connected.
+-----------------------------------------------------------------------*/
+int PrunedLabelIndex::distance(int a, int b) const {
+    if (a == b) return 0;
+
+    // Both labels are sorted by hub rank; walk them together
+    int i = offsets[a], iEnd = offsets[a + 1];
+    int j = offsets[b], jEnd = offsets[b + 1];
+    int best = -1;
+    while (i < iEnd && j < jEnd) {
+        if (hubs[i] == hubs[j]) {
+            int through = hubDistances[i] + hubDistances[j];
+            if (best == -1 || through < best) best = through;
+            i++;
+            j++;
+        }
+        else if (hubs[i] < hubs[j]) {
+            i++;
+        }
+        else {
+            j++;
+        }
+    }
+    return best;
+}
+
+/*-----------------------------------------------------------------------
+    Write the index to a binary file.
+
+    Postcondition: Returns true if successful, false otherwise.
+-----------------------------------------------------------------------*/
+bool PrunedLabelIndex::saveToFile(const string& indexFile) const {
+    ofstream outFile(indexFile, ios::binary);
+    if (!outFile) {
+        cerr << "Error: Could not open file for writing: " << indexFile << endl;
+        return false;
+    }
+
+    int count = nodeCount();
+    uint64_t entries = hubs.size();
+    outFile.write((const char*)&FileMagic, sizeof(FileMagic));
+    outFile.write((const char*)&fingerprint, sizeof(fingerprint));
+    outFile.write((const char*)&count, sizeof(count));
+    outFile.write((const char*)&entries, sizeof(entries));
+    outFile.write((const char*)offsets.data(), offsets.size() * sizeof(int));
+    outFile.write((const char*)hubs.data(), hubs.size() * sizeof(int));
+    outFile.write((const char*)hubDistances.data(), hubDistances.size() * sizeof(uint16_t));
+    return (bool)outFile;
+}
+
+/*-----------------------------------------------------------------------
+    Read a saved index if its fingerprint is expected.
+
+    Postcondition: Returns true and replaces the index if the file was
+                  read, matches and holds well-formed labels; otherwise
+                  the index is unchanged.
+-----------------------------------------------------------------------*/
+bool PrunedLabelIndex::load(const string& indexFile, uint64_t expected, int expectedCount) {
+    ifstream inFile(indexFile, ios::binary);
+    if (!inFile) {
+        cerr << "Error: Could not open file: " << indexFile << endl;
+        return false;
+    }
+
+    uint32_t magic = 0;
+    uint64_t savedFingerprint = 0, entries = 0;
+    int count = -1;
+    inFile.read((char*)&magic, sizeof(magic));
+    inFile.read((char*)&savedFingerprint, sizeof(savedFingerprint));
+    inFile.read((char*)&count, sizeof(count));
+    inFile.read((char*)&entries, sizeof(entries));
+    if (!inFile || magic != FileMagic || count < 0) {
+        cerr << "Error: Not a label index file: " << indexFile << endl;
+        return false;
+    }
+    if (savedFingerprint != expected || count != expectedCount) {
+        cerr << "Error: Label index does not match the graph: " << indexFile << endl;
+        return false;
+    }
+
+    // Check the sizes against the file before allocating anything
+    streamoff header = inFile.tellg();
+    inFile.seekg(0, ios::end);
+    uint64_t remaining = (uint64_t)(inFile.tellg() - header);
+    inFile.seekg(header);
+    uint64_t entrySize = sizeof(int) + sizeof(uint16_t);
+    uint64_t offsetBytes = ((uint64_t)count + 1) * sizeof(int);
+    if (remaining < offsetBytes || entries != (remaining - offsetBytes) / entrySize ||
+        remaining != offsetBytes + entries * entrySize) {
+        cerr << "Error: Label index file has the wrong size: " << indexFile << endl;
+        return false;
+    }
+
+    vector<int> newOffsets(count + 1);
+    vector<int> newHubs(entries);
+    vector<uint16_t> newDistances(entries);
+    inFile.read((char*)newOffsets.data(), newOffsets.size() * sizeof(int));
+    inFile.read((char*)newHubs.data(), newHubs.size() * sizeof(int));
+    inFile.read((char*)newDistances.data(), newDistances.size() * sizeof(uint16_t));
+    if (!inFile || newOffsets[0] != 0 || newOffsets[count] != (int)entries) {
+        cerr << "Error: Label index file is truncated: " << indexFile << endl;
+        return false;
+    }
+
+    // Queries index by the offsets and merge labels by hub rank, so every
+    // label must lie inside hubs and list ranks below count in order
+    for (int id = 0; id < count; id++) {
+        if (newOffsets[id] > newOffsets[id + 1]) {
+            cerr << "Error: Label index file is corrupt: " << indexFile << endl;
+            return false;
+        }
+        for (int i = newOffsets[id]; i < newOffsets[id + 1]; i++) {
+            if (newHubs[i] < 0 || newHubs[i] >= count || (i > newOffsets[id] && newHubs[i] <= newHubs[i - 1])) {
+                cerr << "Error: Label index file is corrupt: " << indexFile << endl;
+                return false;
+            }
+        }
+    }
+
+    offsets.swap(newOffsets);
+    hubs.swap(newHubs);
+    hubDistances.swap(newDistances);
+    fingerprint = savedFingerprint;
+    return true;
+}
+
+/*-----------------------------------------------------------------------
+    Hash one friendship.
+
+    Postcondition: Returns a well-mixed 64-bit value of the pair.
+-----------------------------------------------------------------------*/
+uint64_t PrunedLabelIndex::edgeHash(int a, int b) {
+    // splitmix64 finalizer
+    uint64_t x = ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
@@ -0,0 +1,192 @@
+/******************************************************************************
+ * Class: PrunedLabelIndex
+ *
+ * Description: Exact distance index using pruned landmark labeling (2-hop
+ *              labels, after Akiba, Iwata and Yoshida). Every person gets a
+ *              short list of (hub, distance) pairs such that any shortest
+ *              path between two people passes through a hub both of them
+ *              list. The exact distance is then found by merging the two
+ *              sorted lists.
+ *
+ *              The labels are built by one BFS per person, in order of
+ *              decreasing degree, and each BFS stops wherever the labels
+ *              built so far already give the right distance. After the
+ *              first hubs, which do most of the pruning and are processed
+ *              one at a time, the searches run in parallel rounds. A round
+ *              only prunes against the labels of earlier rounds, which can
+ *              add a few labels but never breaks exactness.
+ *
+ *              Node IDs are those of the graph view the index was built
+ *              from (SocialGraph::Snapshot or GraphSnapshot).
+ *              A saved index records a fingerprint of that view's edges and
+ *              only loads against a view with the same edges.
+ *
+ * Member Variables:
+ *    - offsets: Start of each person's label inside hubs
+ *    - hubs: Hub ranks of all labels back to back, sorted per person
+ *    - hubDistances: Distance to the hub of each label entry
+ *    - fingerprint: Fingerprint of the graph the labels describe
+ *
+ *****************************************************************************/
+
+#ifndef PRUNEDLABELINDEX_H
+#define PRUNEDLABELINDEX_H
+
+#include "FriendLists.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class PrunedLabelIndex {
+public:
+    /*** Constructers ***/
+    PrunedLabelIndex() : offsets(1, 0), fingerprint(0) {}
+    /*-------------------------------------------------------------------
+      Create an empty index, to be filled by loadFromFile().
+     ------------------------------------------------------------------*/
+
+    template <class Graph>
+    explicit PrunedLabelIndex(const Graph& graph, int threadCount = 0);
+    /*-------------------------------------------------------------------
+      Build the labels of a graph.
+
+      Precondition:  threadCount of 0 uses one thread per hardware thread.
+      Postcondition: distance() answers exactly for every pair of node IDs
+                     of graph.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return (int)offsets.size() - 1; }
+    size_t labelCount() const { return hubs.size(); }
+    /*-------------------------------------------------------------------
+      Get the number of node IDs and of (hub, distance) entries.
+     ------------------------------------------------------------------*/
+
+    /*** Queries **/
+    int distance(int a, int b) const;
+    /*-------------------------------------------------------------------
+      Get the exact hop distance between two people.
+
+      Precondition:  a and b are node IDs below nodeCount().
+      Postcondition: Returns the distance, or -1 if they are not connected.
+                     Costs one merge of the two labels.
+     ------------------------------------------------------------------*/
+
+    template <class Graph>
+    vector<int> findPath(const Graph& graph, int from, int to) const;
+    /*-------------------------------------------------------------------
+      Rebuild a shortest path from the distances.
+
+      Precondition:  graph is the view the index was built from.
+      Postcondition: Returns the node IDs of a shortest path from from to
+                     to, or an empty vector if there is none. Each step
+                     moves to the first friend one hop closer to to.
+     ------------------------------------------------------------------*/
+
+    /*** Persistence **/
+    bool saveToFile(const string& indexFile) const;
+    /*-------------------------------------------------------------------
+      Write the index to a binary file.
+
+      Postcondition: Returns true if successful. The file uses the byte
+                     order of this machine.
+     ------------------------------------------------------------------*/
+
+    template <class Graph>
+    bool loadFromFile(const string& indexFile, const Graph& graph) {
+        return load(indexFile, fingerprintOf(graph), graph.nodeCount());
+    }
+    /*-------------------------------------------------------------------
+      Read an index written by saveToFile().
+
+      Precondition:  graph is the view the saved index belongs to.
+      Postcondition: Returns true and replaces the index if the file was
+                     read and matches graph; otherwise the index is kept.
+                     A file whose offsets or hub ranks are out of range
+                     or out of order is rejected.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    vector<int> offsets;            // nodeCount() + 1 offsets into hubs
+    vector<int> hubs;               // Hub rank of each label entry
+    vector<uint16_t> hubDistances;  // Distance of each label entry
+    uint64_t fingerprint;           // fingerprintOf() the indexed graph
+
+    /***** Helper Functions *****/
+    void build(const FriendLists& adjacency, int threadCount);
+    /*-----------------------------------------------------------------------
+      Build the labels of a graph given by its friend lists.
+
+      Postcondition: offsets, hubs and hubDistances hold the labels.
+     ----------------------------------------------------------------------*/
+
+    bool load(const string& indexFile, uint64_t expected, int expectedCount);
+    /*-----------------------------------------------------------------------
+      Read a saved index if its fingerprint and node count are expected and
+      its labels are well formed.
+     ----------------------------------------------------------------------*/
+
+    static uint64_t edgeHash(int a, int b);
+    /*-----------------------------------------------------------------------
+      Hash one friendship, given with a < b.
+     ----------------------------------------------------------------------*/
+
+    template <class Graph>
+    static uint64_t fingerprintOf(const Graph& graph) {
+        // Summing the edge hashes ignores the order of the friend lists
+        uint64_t sum = edgeHash(graph.nodeCount(), -1);
+        for (int id = 0; id < graph.nodeCount(); id++) {
+            for (int friendId : graph.neighbors(id)) {
+                if (id < friendId) sum += edgeHash(id, friendId);
+            }
+        }
+        return sum;
+    }
+    /*-----------------------------------------------------------------------
+      Fingerprint the node count and friendships of a graph.
+     ----------------------------------------------------------------------*/
+};
+
+/*-----------------------------------------------------------------------
+    Build the labels of a graph.
+
+    Postcondition: distance() answers exactly for graph.
+-----------------------------------------------------------------------*/
+template <class Graph>
+PrunedLabelIndex::PrunedLabelIndex(const Graph& graph, int threadCount)
+    : fingerprint(fingerprintOf(graph)) {
+    // Build on a copy of the friend lists; the searches read them many times
+    build(FriendLists(graph), threadCount);
+}
+
+/*-----------------------------------------------------------------------
+    Rebuild a shortest path from the distances.
+
+    Precondition:  graph is the view the index was built from.
+    Postcondition: Returns the node IDs of a shortest path, or an empty
+                  vector if to can't be reached.
+-----------------------------------------------------------------------*/
+template <class Graph>
+vector<int> PrunedLabelIndex::findPath(const Graph& graph, int from, int to) const {
+    vector<int> path;
+    int remaining = distance(from, to);
+    if (remaining == -1) return path;
+
+    path.push_back(from);
+    for (int current = from; remaining > 0; remaining--) {
+        for (int friendId : graph.neighbors(current)) {
+            if (distance(friendId, to) == remaining - 1) {
+                current = friendId;
+                break;
+            }
+        }
+        path.push_back(current);
+    }
+    return path;
+}
+
+#endif
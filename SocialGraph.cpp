@@ -4,15 +4,139 @@
   - Implementation of all functions mentioned in .h file
 ------------------------------------------------------------------------*/
 #include "SocialGraph.h"
+#include "TraversalWorkspace.h"
+#include "ParallelBFS.h"
+#include "MultiSourceBFS.h"
+#include "PathEnumerator.h"
+#include "PageRank.h"
+#include <functional>
 #include <algorithm>
 #include <queue>
 #include <vector>
 #include <cassert>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <thread>
 
 using namespace std;
+
+namespace {
+    /***** Hazard Slot (the version one thread is reading) *****/
+    struct alignas(64) HazardSlot {
+        atomic<const void*> state{nullptr};  // Version of the outermost read, if any
+        atomic<bool> taken{false};           // Owned by a running thread
+        HazardSlot* next = nullptr;          // Slots are reused, never freed
+        int depth = 0;                       // Live ReadGuards of the owner
+    };
+
+    // Every slot ever handed out, newest first
+    atomic<HazardSlot*> hazardSlots(nullptr);
+
+    // Claims a slot for the calling thread and frees it when the thread ends
+    struct HazardOwner {
+        HazardSlot* slot;
+
+        HazardOwner() {
+            for (slot = hazardSlots.load(memory_order_acquire); slot; slot = slot->next) {
+                bool expected = false;
+                if (slot->taken.compare_exchange_strong(expected, true, memory_order_acquire)) return;
+            }
+            slot = new HazardSlot;
+            slot->taken.store(true, memory_order_relaxed);
+            HazardSlot* head = hazardSlots.load(memory_order_relaxed);
+            do {
+                slot->next = head;
+            } while (!hazardSlots.compare_exchange_weak(head, slot, memory_order_release, memory_order_relaxed));
+        }
+
+        ~HazardOwner() {
+            slot->depth = 0;
+            slot->state.store(nullptr, memory_order_release);
+            slot->taken.store(false, memory_order_release);
+        }
+    };
+
+    thread_local HazardOwner hazardOwner;
+
+    // Edit tokens of friend lists changed outside the publish step. They
+    // start above any version number, so no version edits such a list in
+    // place, and each is used by a single change.
+    atomic<uint64_t> nextEditToken(uint64_t(1) << 63);
+
+    // Name index buckets of a new, empty version
+    const int InitialBuckets = 16;
+
+    // A path search whose queue holds this many people is about to sweep
+    // a large part of a large network; only then does it pay to start the
+    // threads of the parallel BFS
+    const int ParallelFrontier = 1 << 16;
+}
+
+/*-----------------------------------------------------------------------
+    Construct an empty social network.
+
+    Precondition:  shardCount > 0.
+    Postcondition: Version 0, holding no people, is published.
+-----------------------------------------------------------------------*/
+SocialGraph::SocialGraph(int shardCount)
+    : current(emptyState(0)), shards(shardCount) {
+    published.store(current.get());
+}
+
+/*-----------------------------------------------------------------------
+    Pin the current version of a graph for the length of a read.
+
+    Postcondition: The version stays alive until the guard is destroyed.
+-----------------------------------------------------------------------*/
+SocialGraph::ReadGuard::ReadGuard(const SocialGraph& graph) {
+    HazardSlot& slot = *hazardOwner.slot;
+    if (slot.depth == 0) {
+        // Outermost read on this thread: announce the version, then make
+        // sure it was still current. A writer retiring it afterwards is
+        // bound to see the announcement and keep the version alive.
+        const State* latest = graph.published.load(memory_order_acquire);
+        while (true) {
+            slot.state.store(latest, memory_order_seq_cst);
+            const State* check = graph.published.load(memory_order_seq_cst);
+            if (check == latest) break;
+            latest = check;
+        }
+        state = latest;
+    }
+    else {
+        // Read published once: a version published after the comparison
+        // would not be announced by the slot
+        const State* latest = graph.published.load(memory_order_acquire);
+        if (slot.state.load(memory_order_relaxed) == latest) {
+            // An outer guard already protects the current version
+            state = latest;
+        }
+        else {
+            // An outer guard holds an older version or another graph, so pin our own
+            pinned = atomic_load(&graph.current);
+            state = pinned.get();
+        }
+    }
+    slot.depth++;
+}
+
+/*-----------------------------------------------------------------------
+    Release a pinned version.
+
+    Postcondition: Once the outermost guard of the thread is gone, the
+                  thread no longer keeps any version alive.
+-----------------------------------------------------------------------*/
+SocialGraph::ReadGuard::~ReadGuard() {
+    HazardSlot& slot = *hazardOwner.slot;
+    if (--slot.depth == 0) {
+        slot.state.store(nullptr, memory_order_release);
+    }
+}
+
 /*-----------------------------------------------------------------------
     Add a new person to the social network.
 
@@ -20,10 +144,10 @@ using namespace std;
     Postcondition: A new node with the given name is added to the graph.
 -----------------------------------------------------------------------*/
 void SocialGraph::addPerson(const string& name) {
-    Node newNode(name);
-    if (!nodeExists(newNode)) {
-        nodes.push_back(newNode);
-    }
+    // A new person has no friends yet, so no shard has to be locked
+    PendingWrite write;
+    write.apply = [&name](State& state) { return applyAddPerson(state, name); };
+    commit(write);
 }
 
 /*-----------------------------------------------------------------------
@@ -34,27 +158,12 @@ void SocialGraph::addPerson(const string& name) {
                   Returns true if removal was successful, false otherwise.
 -----------------------------------------------------------------------*/
 bool SocialGraph::removePerson(const string& name) {
-    Node nodeToRemove(name);
-    if (!nodeExists(nodeToRemove)) {
-        return false;
-    }
-
-    // Remove all edges connected to this node by filtering edges where the node appears
-    edgeList.erase(
-        remove_if(edgeList.begin(), edgeList.end(),
-            [&nodeToRemove](const Edge& edge) {
-                return edge.getFirstNode() == nodeToRemove || edge.getSecondNode() == nodeToRemove;
-            }),
-        edgeList.end()
-    );
-
-    // Remove the node
-    nodes.erase(
-        remove(nodes.begin(), nodes.end(), nodeToRemove),
-        nodes.end()
-    );
-
-    return true;
+    // The records of all friends change, wherever their shards are
+    vector<unique_lock<mutex>> locks = lockAllShards();
+    PendingWrite write;
+    write.apply = [&name](State& state) { return applyRemovePerson(state, name); };
+    commit(write);
+    return write.changed;
 }
 
 /*-----------------------------------------------------------------------
@@ -64,67 +173,437 @@ bool SocialGraph::removePerson(const string& name) {
     Postcondition: An edge is created between the two nodes if they exist.
 -----------------------------------------------------------------------*/
 void SocialGraph::addFriend(const string& name1, const string& name2) {
-    Node node1(name1), node2(name2);
-
-    // Check both exist and aren't the same node
-    if (nodeExists(node1) && nodeExists(node2) && name1 != name2) {
-        // Check if friendship already exists
-        bool alreadyFriends = false;
-        for (const Edge& edge : edgeList) {
-            if (edge.connects(node1, node2)) {
-                alreadyFriends = true;
+    changeFriendship(name1, name2, true);
+}
+
+/*-----------------------------------------------------------------------
+    Remove friendship between two people.
+
+    Precondition:  name1 and name2 are valid names of people in the graph.
+    Postcondition: The edge between the two nodes is removed if it exists.
+-----------------------------------------------------------------------*/
+void SocialGraph::removeFriend(const string& name1, const string& name2) {
+    changeFriendship(name1, name2, false);
+}
+
+/*-----------------------------------------------------------------------
+    Apply a list of changes as one new version.
+
+    Precondition:  batch holds the changes in the order to apply them.
+    Postcondition: Element i of the result is true if batch[i] changed the
+                  graph. All of the changes are published together.
+-----------------------------------------------------------------------*/
+vector<bool> SocialGraph::applyBatch(const vector<Mutation>& batch) {
+    vector<bool> results(batch.size(), false);
+
+    // Any record may change, so keep the shard writers out
+    vector<unique_lock<mutex>> locks = lockAllShards();
+    PendingWrite write;
+    write.apply = [&batch, &results](State& state) {
+        bool changed = false;
+        for (size_t i = 0; i < batch.size(); i++) {
+            const Mutation& mutation = batch[i];
+            switch (mutation.kind) {
+            case Mutation::AddPerson:
+                results[i] = applyAddPerson(state, mutation.name1);
+                break;
+            case Mutation::RemovePerson:
+                results[i] = applyRemovePerson(state, mutation.name1);
+                break;
+            case Mutation::AddFriend:
+                results[i] = applyAddFriend(state, mutation.name1, mutation.name2);
+                break;
+            case Mutation::RemoveFriend:
+                results[i] = applyRemoveFriend(state, mutation.name1, mutation.name2);
                 break;
             }
+            changed = changed || results[i];
+        }
+        return changed;
+    };
+    commit(write);
+    return results;
+}
+
+/*-----------------------------------------------------------------------
+    Add or remove a friendship, locking only the shards of the two people.
+
+    Postcondition: Returns true if the friendship was added or removed.
+-----------------------------------------------------------------------*/
+bool SocialGraph::changeFriendship(string_view name1, string_view name2, bool add) {
+    while (true) {
+        int id1, id2;
+        {
+            ReadGuard state(*this);
+            id1 = state->findId(name1);
+            id2 = state->findId(name2);
+        }
+        if (id1 == -1 || id2 == -1 || id1 == id2) return false;
+
+        // Lock the two shards in index order so writers never deadlock
+        size_t shard1 = shardOf(id1), shard2 = shardOf(id2);
+        unique_lock<mutex> firstLock(shards[min(shard1, shard2)].lock);
+        unique_lock<mutex> secondLock;
+        if (shard1 != shard2) {
+            secondLock = unique_lock<mutex>(shards[max(shard1, shard2)].lock);
         }
 
-        if (!alreadyFriends) {
-            // Add new edge
-            edgeList.push_back(Edge(node1, node2));
+        // Only this writer can change the two records now, but either
+        // person may have been removed before the locks were taken
+        shared_ptr<Person> person1, person2;
+        {
+            ReadGuard state(*this);
+            if (state->findId(name1) != id1 || state->findId(name2) != id2) continue;
+            if (state->hasFriend(id1, id2) == add) return false;
+
+            // Copy the records here, outside the publish step. They share
+            // every chunk of their friend lists with the current version.
+            // The copies are shared as soon as they are published, so owner
+            // 0 keeps later versions from editing them in place.
+            person1 = make_shared<Person>(*state->person(id1));
+            person2 = make_shared<Person>(*state->person(id2));
+            person1->owner = person2->owner = 0;
         }
+        uint64_t token = nextEditToken.fetch_add(1);
+        if (add) {
+            person1->friends.append(id2, token);
+            person2->friends.append(id1, token);
+        }
+        else {
+            eraseFriend(person1->friends, id2, token);
+            eraseFriend(person2->friends, id1, token);
+        }
+
+        // Both records go into the same version
+        PendingWrite write;
+        write.apply = [&](State& state) {
+            state.people.assign(id1, person1, state.version);
+            state.people.assign(id2, person2, state.version);
+            int change = add ? 1 : -1;
+            recountDegree(state, (int)person1->friends.size() - change, change);
+            recountDegree(state, (int)person2->friends.size() - change, change);
+            if (add) {
+                state.friendshipCount++;
+                joinComponents(state, id1, id2);
+            }
+            else {
+                state.friendshipCount--;
+                state.componentsExact = false;
+            }
+            return true;
+        };
+        commit(write);
+        return true;
     }
 }
 
 /*-----------------------------------------------------------------------
-    Remove friendship between two people.
+    Apply a change to the next version and publish it.
 
-    Precondition:  name1 and name2 are valid names of people in the graph.
-    Postcondition: The edge between the two nodes is removed if it exists.
+    Precondition:  The caller holds the shards of every record that
+                  write.apply replaces without reading the version.
+    Postcondition: write.changed holds the result of write.apply.
 -----------------------------------------------------------------------*/
-void SocialGraph::removeFriend(const string& name1, const string& name2) {
-    Node node1(name1), node2(name2);
-    // Removes the edge connecting n1 and n2 by filtering
-    edgeList.erase(
-        remove_if(edgeList.begin(), edgeList.end(),
-            [&node1, &node2](const Edge& edge) {
-                return edge.connects(node1, node2);
-            }),
-        edgeList.end()
+void SocialGraph::commit(PendingWrite& write) {
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        pending.push_back(&write);
+    }
+
+    lock_guard<mutex> lock(publishMutex);
+    if (write.done) {
+        // Published by the writer that held the lock before us
+        return;
+    }
+
+    // Group commit: everything queued so far goes into one version, so the
+    // path copying and the pointer swap are paid once per batch
+    vector<PendingWrite*> batch;
+    {
+        lock_guard<mutex> queueLock(pendingMutex);
+        batch.swap(pending);
+    }
+    shared_ptr<State> next = beginWrite();
+    bool changed = false;
+    for (PendingWrite* queued : batch) {
+        queued->changed = queued->apply(*next);
+        changed = changed || queued->changed;
+    }
+    if (changed) {
+        publish(next);
+    }
+    for (PendingWrite* queued : batch) {
+        queued->done = true;
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Lock every shard.
+
+    Postcondition: Returns the locks, taken in index order.
+-----------------------------------------------------------------------*/
+vector<unique_lock<mutex>> SocialGraph::lockAllShards() {
+    vector<unique_lock<mutex>> locks;
+    locks.reserve(shards.size());
+    for (Shard& shard : shards) {
+        locks.emplace_back(shard.lock);
+    }
+    return locks;
+}
+
+/*-----------------------------------------------------------------------
+    Start building the next version.
+
+    Precondition:  publishMutex is held.
+    Postcondition: Returns a copy of the current version with the next
+                  version number. Only the roots are copied.
+-----------------------------------------------------------------------*/
+shared_ptr<SocialGraph::State> SocialGraph::beginWrite() const {
+    shared_ptr<const State> latest = atomic_load(&current);
+    shared_ptr<State> next = make_shared<State>(*latest);
+    // The version number doubles as the edit token of the new version
+    next->version = latest->version + 1;
+    return next;
+}
+
+/*-----------------------------------------------------------------------
+    Make a version visible to readers.
+
+    Precondition:  publishMutex is held; next came from beginWrite().
+    Postcondition: New reads see next. The graph keeps each replaced
+                  version until no thread announces it, so it is freed by
+                  the first publish after its last read ends; until the
+                  next write, it stays alive however long ago that was.
+-----------------------------------------------------------------------*/
+void SocialGraph::publish(shared_ptr<State> next) {
+    const State* latest = next.get();
+    retired.push_back(atomic_exchange(&current, shared_ptr<const State>(move(next))));
+    published.store(latest, memory_order_seq_cst);
+
+    // Scanning the slots after the swap sees every read that could still
+    // have picked up a retired version
+    vector<const void*> reading;
+    for (HazardSlot* slot = hazardSlots.load(memory_order_acquire); slot; slot = slot->next) {
+        const void* state = slot->state.load(memory_order_seq_cst);
+        if (state) reading.push_back(state);
+    }
+    size_t kept = 0;
+    for (shared_ptr<const State>& version : retired) {
+        if (find(reading.begin(), reading.end(), version.get()) != reading.end()) {
+            retired[kept++] = move(version);
+        }
+    }
+    retired.resize(kept);
+}
+
+/*-----------------------------------------------------------------------
+    Create a version holding no people.
+
+    Postcondition: Returns a version with a fresh arena and an empty index.
+-----------------------------------------------------------------------*/
+shared_ptr<SocialGraph::State> SocialGraph::emptyState(uint64_t version) {
+    shared_ptr<State> state = make_shared<State>();
+    state->arena = make_shared<NameArena>();
+    state->version = version;
+    for (int i = 0; i < InitialBuckets; i++) {
+        state->nameIndex.append(nullptr, version);
+    }
+    return state;
+}
+
+/*-----------------------------------------------------------------------
+    Add a person to an unpublished version.
+
+    Precondition:  state has not been published.
+    Postcondition: Returns true if name was not already present.
+-----------------------------------------------------------------------*/
+bool SocialGraph::applyAddPerson(State& state, string_view name) {
+    if (state.findId(name) != -1) return false;
+
+    // The arena copy is the only one; the record and index refer to it
+    shared_ptr<Person> person = make_shared<Person>();
+    person->owner = state.version;
+    person->name = state.arena->store(name);
+    int id = state.people.size();
+    state.people.append(person, state.version);
+    state.componentParent.append(id, state.version);
+    state.componentSize.append(1, state.version);
+    state.componentCount++;
+    if (state.degreeCounts.size() == 0) state.degreeCounts.append(0, state.version);
+    state.degreeCounts.assign(0, state.degreeCounts[0] + 1, state.version);
+
+    int bucket = (int)(hash<string_view>()(person->name) & (state.nameIndex.size() - 1));
+    editBucket(state, bucket).entries.emplace_back(person->name, id);
+    state.personCount++;
+    if (state.personCount > 2 * (size_t)state.nameIndex.size()) {
+        growIndex(state);
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------
+    Remove a person and their friendships from an unpublished version.
+
+    Precondition:  state has not been published.
+    Postcondition: Returns true if name was present.
+-----------------------------------------------------------------------*/
+bool SocialGraph::applyRemovePerson(State& state, string_view name) {
+    int id = state.findId(name);
+    if (id == -1) {
+        return false;
+    }
+
+    // Remove this node from each friend's list, then drop its record
+    const Person* removed = state.person(id);
+    for (int friendId : removed->friends) {
+        recountDegree(state, (int)state.person(friendId)->friends.size(), -1);
+        eraseFriend(editPerson(state, friendId).friends, id, state.version);
+    }
+    state.friendshipCount -= removed->friends.size();
+    int degree = (int)removed->friends.size();
+    state.degreeCounts.assign(degree, state.degreeCounts[degree] - 1, state.version);
+
+    // The class keeps the ID but loses a person. If they had friends, the
+    // rest of the class may have fallen apart.
+    int root = findComponent(state, id);
+    int remaining = state.componentSize[root] - 1;
+    state.componentSize.assign(root, remaining, state.version);
+    if (remaining == 0) state.componentCount--;
+    if (!removed->friends.empty()) state.componentsExact = false;
+
+    // Node IDs are never reused, so the slot is only emptied.
+    // The name stays in the arena until the graph is reloaded.
+    int bucket = (int)(hash<string_view>()(name) & (state.nameIndex.size() - 1));
+    vector<pair<string_view, int>>& entries = editBucket(state, bucket).entries;
+    entries.erase(
+        remove_if(entries.begin(), entries.end(),
+            [id](const pair<string_view, int>& entry) { return entry.second == id; }),
+        entries.end()
     );
+    state.people.assign(id, nullptr, state.version);
+    state.personCount--;
+    return true;
+}
+
+/*-----------------------------------------------------------------------
+    Add a friendship to an unpublished version.
+
+    Precondition:  state has not been published.
+    Postcondition: Returns true if both people exist, differ and were not
+                  already friends.
+-----------------------------------------------------------------------*/
+bool SocialGraph::applyAddFriend(State& state, string_view name1, string_view name2) {
+    int id1 = state.findId(name1), id2 = state.findId(name2);
+
+    // Check both exist, aren't the same node and aren't already friends
+    if (id1 == -1 || id2 == -1 || id1 == id2 || state.hasFriend(id1, id2)) {
+        return false;
+    }
+    recountDegree(state, (int)state.person(id1)->friends.size(), 1);
+    recountDegree(state, (int)state.person(id2)->friends.size(), 1);
+    editPerson(state, id1).friends.append(id2, state.version);
+    editPerson(state, id2).friends.append(id1, state.version);
+    state.friendshipCount++;
+    joinComponents(state, id1, id2);
+    return true;
 }
 
+/*-----------------------------------------------------------------------
+    Remove a friendship from an unpublished version.
+
+    Precondition:  state has not been published.
+    Postcondition: Returns true if the two people were friends.
+-----------------------------------------------------------------------*/
+bool SocialGraph::applyRemoveFriend(State& state, string_view name1, string_view name2) {
+    int id1 = state.findId(name1), id2 = state.findId(name2);
+    if (id1 == -1 || id2 == -1 || !state.hasFriend(id1, id2)) return false;
+
+    recountDegree(state, (int)state.person(id1)->friends.size(), -1);
+    recountDegree(state, (int)state.person(id2)->friends.size(), -1);
+    eraseFriend(editPerson(state, id1).friends, id2, state.version);
+    eraseFriend(editPerson(state, id2).friends, id1, state.version);
+    state.friendshipCount--;
+    state.componentsExact = false;
+    return true;
+}
+
+/*-----------------------------------------------------------------------
+    Get a person record of an unpublished version for writing.
+
+    Precondition:  id is a living person of state.
+    Postcondition: Returns a record owned by state.
+-----------------------------------------------------------------------*/
+SocialGraph::Person& SocialGraph::editPerson(State& state, int id) {
+    const shared_ptr<const Person>& person = state.people[id];
+    if (person->owner == state.version) {
+        // Created while building this version; nobody else can see it
+        return const_cast<Person&>(*person);
+    }
+    shared_ptr<Person> copy = make_shared<Person>(*person);
+    copy->owner = state.version;
+    state.people.assign(id, copy, state.version);
+    return *copy;
+}
 
 /*-----------------------------------------------------------------------
-    Count mutual friends between two nodes.
+    Get a name index bucket of an unpublished version for writing.
 
-    Precondition:  Both a and b are valid nodes in the graph.
-    Postcondition: Returns the number of mutual friends between a and b.
+    Precondition:  bucket is a valid bucket of state.
+    Postcondition: Returns a bucket owned by state.
 -----------------------------------------------------------------------*/
-int SocialGraph::countMutualFriends(const Node& a, const Node& b) const {
-    // Using Helper Function
-    vector<Node> aFriends = getFriends(a);
-    vector<Node> bFriends = getFriends(b);
+SocialGraph::NameBucket& SocialGraph::editBucket(State& state, int bucket) {
+    const shared_ptr<const NameBucket>& entries = state.nameIndex[bucket];
+    if (entries && entries->owner == state.version) {
+        return const_cast<NameBucket&>(*entries);
+    }
+    shared_ptr<NameBucket> copy = entries ? make_shared<NameBucket>(*entries) : make_shared<NameBucket>();
+    copy->owner = state.version;
+    state.nameIndex.assign(bucket, copy, state.version);
+    return *copy;
+}
 
-    int count = 0;
-    // Nested loop to compare all friends
-    for (const Node& aFriend : aFriends) {
-        for (const Node& bFriend : bFriends) {
-            if (aFriend == bFriend) {
-                count++;
-                break;
+/*-----------------------------------------------------------------------
+    Double the number of name index buckets.
+
+    Postcondition: Every name is rehashed into the new buckets.
+-----------------------------------------------------------------------*/
+void SocialGraph::growIndex(State& state) {
+    int bucketCount = state.nameIndex.size() * 2;
+    vector<shared_ptr<NameBucket>> buckets(bucketCount);
+    state.nameIndex.forEach([&](int, const shared_ptr<const NameBucket>& old) {
+        if (!old) return;
+        for (const pair<string_view, int>& entry : old->entries) {
+            shared_ptr<NameBucket>& bucket = buckets[hash<string_view>()(entry.first) & (bucketCount - 1)];
+            if (!bucket) {
+                bucket = make_shared<NameBucket>();
+                bucket->owner = state.version;
             }
+            bucket->entries.push_back(entry);
         }
+    });
+
+    PersistentArray<shared_ptr<const NameBucket>> index;
+    for (int i = 0; i < bucketCount; i++) {
+        index.append(buckets[i], state.version);
     }
-    return count;
+    state.nameIndex = index;
+}
+
+/*-----------------------------------------------------------------------
+    Move a person to another friend count while building a version.
+
+    Precondition:  state has not been published; a person with degree
+                  friends is gaining change friends.
+    Postcondition: One person moves from one element of degreeCounts to
+                  another, which is appended first if it is new.
+-----------------------------------------------------------------------*/
+void SocialGraph::recountDegree(State& state, int degree, int change) {
+    int next = degree + change;
+    while (state.degreeCounts.size() <= next) {
+        state.degreeCounts.append(0, state.version);
+    }
+    state.degreeCounts.assign(degree, state.degreeCounts[degree] - 1, state.version);
+    state.degreeCounts.assign(next, state.degreeCounts[next] + 1, state.version);
 }
 
 /*-----------------------------------------------------------------------
@@ -133,16 +612,9 @@ int SocialGraph::countMutualFriends(const Node& a, const Node& b) const {
     Precondition:  name1 and name2 are valid names of people in the graph.
     Postcondition: Returns true if the two nodes are connected, false otherwise.
 -----------------------------------------------------------------------*/
-bool SocialGraph::areConnected(const string& name1, const string& name2) const {
-    Node node1(name1), node2(name2);
-
-    // for each edge in edgelist, check if these nodes are connected
-    for (const Edge& edge : edgeList) {
-        if (edge.connects(node1, node2)) {
-            return true;
-        }
-    }
-    return false;
+bool SocialGraph::Snapshot::areConnected(const string& name1, const string& name2) const {
+    int id1 = state->findId(name1), id2 = state->findId(name2);
+    return id1 != -1 && id2 != -1 && state->hasFriend(id1, id2);
 }
 
 /*------------------------------------------------------------------------------------------
@@ -151,229 +623,749 @@ bool SocialGraph::areConnected(const string& name1, const string& name2) const {
     Precondition:  name is a valid name in the graph, k is the number of recommendations.
     Postcondition: Returns a vector of names of top k recommended friends.
 -------------------------------------------------------------------------------------------*/
-vector<string> SocialGraph::recommendFriends(const string& name, int k) const {
+vector<string> SocialGraph::Snapshot::recommendFriends(const string& name, int k) const {
     vector<string> recommendations;
-    Node source(name);
-    if (!nodeExists(source)) return recommendations;
-
-    vector<Node> currentFriends = getFriends(source);
-    vector<pair<Node, int>> potentialFriends;
-
-    // Find all non-friends with mutual friend counts
-    for (const Node& node : nodes) {
-        if (node == source) continue;
-
-        // Checks if 'node' is already a friend
-        bool isAlreadyFriend = false;
-        for (const Node& friendNode : currentFriends) {
-            if (node == friendNode) {
-                isAlreadyFriend = true;
-                break;
+    int source = state->findId(name);
+    if (source == -1) return recommendations;
+    const ChunkedArray<int>& sourceFriends = state->person(source)->friends;
+
+    // Walk friends of friends once; each visit is one mutual friend.
+    // The workspace distance slot holds the running count.
+    TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(state->people.size());
+    vector<int>& candidates = ws->queue();
+    ws->block(source);
+    for (int friendId : sourceFriends) {
+        ws->block(friendId);    // Already friends, never recommended
+    }
+    for (int friendId : sourceFriends) {
+        for (int candidate : state->person(friendId)->friends) {
+            if (!ws->visited(candidate)) {
+                ws->visit(candidate, friendId, 1);
+                candidates.push_back(candidate);
             }
-        }
-        // If 'node' is not a friend, calculate mutual friend count
-        if (!isAlreadyFriend) {
-            int mutualCount = countMutualFriends(source, node);
-            if (mutualCount > 0) {
-                potentialFriends.emplace_back(node, mutualCount);
+            else if (ws->distance(candidate) > 0) {
+                ws->visit(candidate, friendId, ws->distance(candidate) + 1);
             }
         }
     }
 
-    // Sort by mutual friend count (descending)
-    sort(potentialFriends.begin(), potentialFriends.end(),
-        [](const pair<Node, int>& a, const pair<Node, int>& b) {
-            return a.second > b.second;
+    // Sort by mutual friend count (descending), ties by order added
+    TraversalWorkspace& counts = *ws;
+    sort(candidates.begin(), candidates.end(),
+        [&counts](int a, int b) {
+            if (counts.distance(a) != counts.distance(b)) return counts.distance(a) > counts.distance(b);
+            return a < b;
         });
 
     // incase nb of recomm asked is not enough for potential friends
-    int limit = (k < potentialFriends.size()) ? k : potentialFriends.size();
+    int limit = (k < (int)candidates.size()) ? k : (int)candidates.size();
     // Get top k recommendations
     for (int i = 0; i < limit; i++) {
-        recommendations.push_back(potentialFriends[i].first.getName());
+        recommendations.push_back(string(state->person(candidates[i])->name));
     }
 
     return recommendations;
 }
 
+/*-----------------------------------------------------------------------
+    Recommend friends for a person with a chosen ranking strategy.
+
+    Precondition:  name is a valid name in the graph, k is the number of recommendations.
+    Postcondition: Returns the names of the top k candidates who are not
+                  already friends of name.
+-----------------------------------------------------------------------*/
+vector<string> SocialGraph::Snapshot::recommendFriends(const string& name, int k,
+                                                       const RecommendOptions& options) const {
+    if (options.strategy == RecommendOptions::MutualFriends) return recommendFriends(name, k);
+
+    vector<string> recommendations;
+    int source = state->findId(name);
+    if (source == -1) return recommendations;
+
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max();
+    if (options.budgetMicros >= 0) {
+        deadline = chrono::steady_clock::now() + chrono::microseconds(options.budgetMicros);
+    }
+    vector<pair<int, double>> ranked = PageRank::forwardPush(*this, source, options.epsilon, options.alpha, deadline);
+
+    // The walk mostly stays near name; skip them and their friends
+    for (const pair<int, double>& entry : ranked) {
+        if ((int)recommendations.size() >= k) break;
+        int candidate = entry.first;
+        if (candidate == source || state->hasFriend(source, candidate)) continue;
+        recommendations.push_back(string(state->person(candidate)->name));
+    }
+    return recommendations;
+}
+
 /*-----------------------------------------------------------------------
     Find the shortest path between two people using BFS.
 
     Precondition:  from and to are valid names of people in the graph.
     Postcondition: Returns a vector of names representing the shortest path.
 -----------------------------------------------------------------------*/
-vector<string> SocialGraph::shortestPath(const string& from, const string& to) const {
-    vector<string> path;
-    Node start(from), end(to);
-    if (!nodeExists(start) || !nodeExists(end)) return path;
+vector<string> SocialGraph::Snapshot::shortestPath(const string& from, const string& to) const {
+    return searchPath(from, to, vector<string>(), SearchLimits()).path;
+}
 
-    // Find indices of start and end nodes
-    int start_index = -1, end_index = -1;
-    for (int i = 0; i < nodes.size(); i++) {
-        if (nodes[i] == start) start_index = i;
-        if (nodes[i] == end) end_index = i;
-        if (start_index != -1 && end_index != -1) break;
-    }
+/*--------------------------------------------------------------------------------------------------------
+    Find the shortest path between two people while avoiding specific nodes using BFS.
 
-    // Initialize parent and distance vectors
-    vector<int> parent(nodes.size(), -1);
-    vector<int> distance(nodes.size(), INT_MAX);
-    parent[start_index] = -1; // -1 will mark the start node
-    distance[start_index] = 0;
+    Precondition:  from and to are valid names, blacklist contains nodes to avoid.
+    Postcondition: Returns a vector of names representing the shortest path avoiding blacklisted nodes.
+----------------------------------------------------------------------------------------------------------*/
+vector<string> SocialGraph::Snapshot::shortestPathAvoiding(const string& from, const string& to, const vector<string>& blacklist) const {
+    return searchPath(from, to, blacklist, SearchLimits()).path;
+}
+
+/*-----------------------------------------------------------------------
+    Find the shortest path between two people with a bounded search.
+
+    Precondition:  from and to are valid names of people in the graph.
+    Postcondition: Returns the path found and whether the search was
+                  exhaustive.
+-----------------------------------------------------------------------*/
+SocialGraph::PathResult SocialGraph::Snapshot::shortestPath(const string& from, const string& to,
+                                                            const SearchLimits& limits) const {
+    return searchPath(from, to, vector<string>(), limits);
+}
+
+/*-----------------------------------------------------------------------
+    Find the shortest path avoiding some people with a bounded search.
+
+    Precondition:  from and to are valid names, blacklist contains nodes to avoid.
+    Postcondition: Returns the path found and whether the search was
+                  exhaustive.
+-----------------------------------------------------------------------*/
+SocialGraph::PathResult SocialGraph::Snapshot::shortestPathAvoiding(const string& from, const string& to,
+                                                                    const vector<string>& blacklist,
+                                                                    const SearchLimits& limits) const {
+    return searchPath(from, to, blacklist, limits);
+}
+
+/*-----------------------------------------------------------------------
+    Breadth-first path search shared by the shortestPath variants.
 
-    queue<int> q;
-    q.push(start_index);
+    Precondition:  Negative limits mean no limit.
+    Postcondition: result.path is the shortest path if found.
+                  result.exhaustive is false if a node at maxDepth still
+                  had unvisited friends or maxVisitedNodes people were
+                  visited before the search ended.
+-----------------------------------------------------------------------*/
+SocialGraph::PathResult SocialGraph::Snapshot::searchPath(const string& from, const string& to,
+                                                          const vector<string>& blacklist,
+                                                          const SearchLimits& limits) const {
+    PathResult result;
+    int start_index = state->findId(from), end_index = state->findId(to);
+    if (start_index == -1 || end_index == -1) return result;
+
+    // Different union-find classes are never connected, even while the
+    // classes are stale after removals
+    if (state->componentRoot(start_index) != state->componentRoot(end_index)) return result;
+
+    bool unlimited = limits.maxDepth < 0 && limits.maxVisitedNodes < 0;
+    bool handOver = unlimited && thread::hardware_concurrency() > 1;
+
+    // Reuse this thread's scratch arrays; no O(V) initialization needed.
+    // Blacklisted people count as already visited, so they are never queued
+    TraversalWorkspace::Lease ws = TraversalWorkspace::acquire(state->people.size());
+    for (const string& name : blacklist) {
+        int id = state->findId(name);
+        if (id != -1) ws->block(id);
+    }
+    ws->visit(start_index, -1, 0); // -1 marks the start node
 
+    vector<int>& q = ws->queue();
+    q.push_back(start_index);
+
+    size_t maxVisited = limits.maxVisitedNodes < 0 ? SIZE_MAX : (size_t)limits.maxVisitedNodes;
     bool found = false;
-    while (!q.empty() && !found) {
-        int current = q.front();
-        q.pop();
+    for (size_t head = 0; head < q.size(); head++) {
+        int current = q[head];
 
         if (current == end_index) {
             found = true;
             break;
         }
 
-        vector<Node> neighbors = getFriends(nodes[current]);
-        for (int i = 0; i < neighbors.size(); i++) {
-            // Find index of neighbor
-            int neighbor_index = -1;
-            for (int j = 0; j < nodes.size(); j++) {
-                if (nodes[j] == neighbors[i]) {
-                    neighbor_index = j;
-                    break;
-                }
+        // Most queries end within a few hops. One whose frontier keeps
+        // growing starts over on all cores; redoing the levels searched
+        // so far costs less than finishing them on one.
+        if (handOver && q.size() - head >= (size_t)ParallelFrontier) {
+            vector<int> blocked;
+            for (const string& name : blacklist) {
+                int id = state->findId(name);
+                if (id != -1) blocked.push_back(id);
             }
+            for (int id : ParallelBFS::path(*this, start_index, end_index, blocked)) {
+                result.path.push_back(string(state->person(id)->name));
+            }
+            return result;
+        }
 
-            if (distance[neighbor_index] == INT_MAX) {
-                distance[neighbor_index] = distance[current] + 1;
-                parent[neighbor_index] = current;
-                q.push(neighbor_index);
+        // Each dequeued person counts as visited; stop once the budget is spent
+        if (head >= maxVisited) {
+            result.exhaustive = false;
+            break;
+        }
+
+        // Don't look past maxDepth, but remember if there was more to see
+        bool atDepthLimit = limits.maxDepth >= 0 && ws->distance(current) >= limits.maxDepth;
+        for (int neighbor_index : state->person(current)->friends) {
+            if (!ws->visited(neighbor_index)) {
+                if (atDepthLimit) {
+                    result.exhaustive = false;
+                    break;
+                }
+                ws->visit(neighbor_index, current, ws->distance(current) + 1);
+                q.push_back(neighbor_index);
             }
         }
     }
 
-    // Reconstruct path if found
+    // Reconstruct path if found; the shortest path is then known for sure
     if (found) {
+        result.exhaustive = true;
         vector<int> index_path;
-        for (int v = end_index; v != -1; v = parent[v]) {
+        for (int v = end_index; v != -1; v = ws->parent(v)) {
             index_path.push_back(v);
         }
         reverse(index_path.begin(), index_path.end());
 
-        for (int i = 0; i < index_path.size(); i++) {
-            path.push_back(nodes[index_path[i]].getName());
+        for (int i = 0; i < (int)index_path.size(); i++) {
+            result.path.push_back(string(state->person(index_path[i])->name));
         }
     }
 
-    return path;
+    return result;
 }
 
-/*--------------------------------------------------------------------------------------------------------
-    Find the shortest path between two people while avoiding specific nodes using BFS.
+/*-----------------------------------------------------------------------
+    Find the shortest paths of many pairs of people at once.
 
-    Precondition:  from and to are valid names, blacklist contains nodes to avoid.
-    Postcondition: Returns a vector of names representing the shortest path avoiding blacklisted nodes.
-----------------------------------------------------------------------------------------------------------*/
-vector<string> SocialGraph::shortestPathAvoiding(const string& from, const string& to, const vector<string>& blacklist) const {
-    vector<string> path;
-    Node start(from), end(to);
-    if (!nodeExists(start) || !nodeExists(end)) return path;
+    Precondition:  Each query is a (from, to) pair of names.
+    Postcondition: Element i is a shortest path of query i, or empty if
+                  either name is unknown or no path exists.
+-----------------------------------------------------------------------*/
+vector<vector<string>> SocialGraph::Snapshot::shortestPaths(const vector<pair<string, string>>& queries) const {
+    // Resolve the names, leaving out queries that can't have a path
+    vector<pair<int, int>> known;
+    vector<int> positions;
+    for (int i = 0; i < (int)queries.size(); i++) {
+        int from = state->findId(queries[i].first), to = state->findId(queries[i].second);
+        // People in different components get an empty path without a search
+        if (from == -1 || to == -1 || state->componentRoot(from) != state->componentRoot(to)) continue;
+        known.emplace_back(from, to);
+        positions.push_back(i);
+    }
 
-    // Find indices of start and end nodes
-    int start_index = -1, end_index = -1;
-    for (int i = 0; i < nodes.size(); i++) {
-        if (nodes[i] == start) start_index = i;
-        if (nodes[i] == end) end_index = i;
-        if (start_index != -1 && end_index != -1) break;
+    // Up to 256 sources share each pass over the friend lists
+    vector<vector<int>> idPaths = MultiSourceBFS::paths(*this, known);
+    vector<vector<string>> paths(queries.size());
+    for (int i = 0; i < (int)known.size(); i++) {
+        vector<string>& path = paths[positions[i]];
+        for (int id : idPaths[i]) {
+            path.push_back(string(state->person(id)->name));
+        }
     }
+    return paths;
+}
 
-    // Convert blacklist to node indices
-    vector<int> blacklistIndices;
-    for (const string& name : blacklist) {
-        Node blackNode(name);
-        for (int i = 0; i < nodes.size(); i++) {
-            if (nodes[i] == blackNode) {
-                blacklistIndices.push_back(i);
-                break;
-            }
+/*-----------------------------------------------------------------------
+    Count the distinct shortest paths between two people.
+
+    Precondition:  from and to are valid names of people in the graph.
+    Postcondition: Returns 0 if either name is unknown or no path exists.
+-----------------------------------------------------------------------*/
+uint64_t SocialGraph::Snapshot::countShortestPaths(const string& from, const string& to) const {
+    int start_index = state->findId(from), end_index = state->findId(to);
+    if (start_index == -1 || end_index == -1) return 0;
+    if (state->componentRoot(start_index) != state->componentRoot(end_index)) return 0;
+    return PathEnumerator::countShortest(*this, start_index, end_index);
+}
+
+/*-----------------------------------------------------------------------
+    Find up to k different paths between two people.
+
+    Precondition:  from and to are valid names of people in the graph.
+    Postcondition: Returns the paths as names, shortest first.
+-----------------------------------------------------------------------*/
+vector<vector<string>> SocialGraph::Snapshot::kShortestPaths(const string& from, const string& to, int k) const {
+    vector<vector<string>> paths;
+    int start_index = state->findId(from), end_index = state->findId(to);
+    if (start_index == -1 || end_index == -1) return paths;
+    if (state->componentRoot(start_index) != state->componentRoot(end_index)) return paths;
+
+    for (const vector<int>& idPath : PathEnumerator::kShortest(*this, start_index, end_index, k)) {
+        vector<string> path;
+        for (int id : idPath) {
+            path.push_back(string(state->person(id)->name));
         }
+        paths.push_back(path);
     }
+    return paths;
+}
 
-    // Initialize parent and visited vectors
-    vector<int> parent(nodes.size(), -1);
-    vector<bool> visited(nodes.size(), false);
-    parent[start_index] = -1; // -1 marks the start node
-    visited[start_index] = true;
+/*-----------------------------------------------------------------------
+    Check if two people are connected by any chain of friendships.
 
-    queue<int> q;
-    q.push(start_index);
+    Precondition:  name1 and name2 are valid names of people in the graph.
+    Postcondition: Returns true if a path exists between them.
+-----------------------------------------------------------------------*/
+bool SocialGraph::Snapshot::inSameComponent(const string& name1, const string& name2) const {
+    int id1 = state->findId(name1), id2 = state->findId(name2);
+    if (id1 == -1 || id2 == -1) return false;
+    if (state->componentRoot(id1) != state->componentRoot(id2)) return false;
+    if (state->componentsExact) return true;
+
+    // The class may have split since it was built; search to be sure
+    return !shortestPath(name1, name2).empty();
+}
 
-    bool found = false;
-    while (!q.empty() && !found) {
-        int current = q.front();
-        q.pop();
+/*-----------------------------------------------------------------------
+    Get the number of connected components.
 
-        if (current == end_index) {
-            found = true;
-            break;
+    Postcondition: Returns the number of components holding people.
+-----------------------------------------------------------------------*/
+size_t SocialGraph::Snapshot::componentCount() const {
+    if (state->componentsExact) return state->componentCount;
+    return componentSizes().size();
+}
+
+/*-----------------------------------------------------------------------
+    Get the sizes of the connected components.
+
+    Postcondition: Returns the number of people in each component,
+                  largest first.
+-----------------------------------------------------------------------*/
+vector<int> SocialGraph::Snapshot::componentSizes() const {
+    if (!state->componentsExact) {
+        // Rebuild in a private copy of the version; only its roots are copied
+        State rebuilt = *state;
+        rebuildComponents(rebuilt);
+        return Snapshot(rebuilt).componentSizes();
+    }
+
+    vector<int> sizes;
+    state->componentParent.forEach([&](int id, int parent) {
+        if (parent == id && state->componentSize[id] > 0) {
+            sizes.push_back(state->componentSize[id]);
         }
+    });
+    sort(sizes.begin(), sizes.end(), greater<int>());
+    return sizes;
+}
 
-        vector<Node> neighbors = getFriends(nodes[current]);
-        for (int i = 0; i < neighbors.size(); i++) {
-            // Find index of neighbor
-            int neighbor_index = -1;
-            for (int j = 0; j < nodes.size(); j++) {
-                if (nodes[j] == neighbors[i]) {
-                    neighbor_index = j;
-                    break;
-                }
-            }
+/*-----------------------------------------------------------------------
+    Get the number of friends of a person.
 
-            // Skip if blacklisted or already visited
-            bool isBlacklisted = false;
-            for (int blackIndex : blacklistIndices) {
-                if (neighbor_index == blackIndex) {
-                    isBlacklisted = true;
-                    break;
-                }
-            }
+    Postcondition: Returns -1 if name is not present.
+-----------------------------------------------------------------------*/
+int SocialGraph::Snapshot::friendCount(const string& name) const {
+    int id = state->findId(name);
+    return id == -1 ? -1 : (int)state->person(id)->friends.size();
+}
 
-            if (!isBlacklisted && !visited[neighbor_index]) {
-                // Mark neighbor as visited
-                visited[neighbor_index] = true;
-                // Store current node as parent
-                parent[neighbor_index] = current;
-                // Add neighbor to queue
-                q.push(neighbor_index);
-            }
+/*-----------------------------------------------------------------------
+    Summarize the friend counts of the network.
+
+    Postcondition: The histogram and percentiles come from degreeCounts
+                  alone. The histogram also tells the smallest count that
+                  makes the top, so one pass over the person records picks
+                  the top people; only their names are copied.
+-----------------------------------------------------------------------*/
+SocialGraph::DegreeStats SocialGraph::Snapshot::degreeStats() const {
+    return degreeStats(10, {50, 90, 99});
+}
+
+SocialGraph::DegreeStats SocialGraph::Snapshot::degreeStats(int topCount, const vector<double>& percentiles) const {
+    DegreeStats stats;
+    size_t people = state->personCount;
+    state->degreeCounts.forEach([&](int, int count) { stats.histogram.push_back(count); });
+    while (!stats.histogram.empty() && stats.histogram.back() == 0) {
+        stats.histogram.pop_back();
+    }
+    if (people > 0) stats.mean = 2.0 * state->friendshipCount / people;
+
+    // Nearest rank: the count of the ceil(p% of n)-th person, fewest first
+    int largest = (int)stats.histogram.size() - 1;
+    for (double percentile : percentiles) {
+        size_t rank = max((size_t)1, (size_t)ceil(percentile / 100 * people));
+        size_t seen = 0;
+        int degree = 0;
+        while (degree < largest && (seen += stats.histogram[degree]) < rank) {
+            degree++;
         }
+        stats.percentiles.push_back(degree);
     }
 
-    // Reconstruct path if found
-    if (found) {
-        vector<int> index_path;
-        for (int v = end_index; v != -1; v = parent[v]) {
-            index_path.push_back(v);
+    size_t wanted = min((size_t)max(topCount, 0), people);
+    if (wanted == 0) return stats;
+    int cut = largest;
+    size_t above = 0;
+    while (above + stats.histogram[cut] < wanted) {
+        above += stats.histogram[cut--];
+    }
+    size_t atCut = wanted - above;   // People with exactly cut friends who make it
+    vector<pair<int, const Person*>> picked;
+    state->people.forEach([&](int, const shared_ptr<const Person>& person) {
+        if (!person) return;
+        int degree = (int)person->friends.size();
+        if (degree > cut || (degree == cut && atCut > 0)) {
+            if (degree == cut) atCut--;
+            picked.emplace_back(degree, person.get());
         }
-        reverse(index_path.begin(), index_path.end());
+    });
+    // People are visited in the order they were added, which a stable
+    // sort keeps among equal counts
+    stable_sort(picked.begin(), picked.end(),
+        [](const pair<int, const Person*>& a, const pair<int, const Person*>& b) { return a.first > b.first; });
+    for (const pair<int, const Person*>& entry : picked) {
+        stats.top.emplace_back(string(entry.second->name), entry.first);
+    }
+    return stats;
+}
+
+/*-----------------------------------------------------------------------
+    Look up the node ID of a person.
+
+    Precondition:  name is the person to find.
+    Postcondition: Returns the node ID, or -1 if name is not in the graph.
+-----------------------------------------------------------------------*/
+int SocialGraph::findId(string_view name) const {
+    return ReadGuard(*this)->findId(name);
+}
 
-        for (int i = 0; i < index_path.size(); i++) {
-            path.push_back(nodes[index_path[i]].getName());
+/*-----------------------------------------------------------------------
+    Take a consistent, read-only view of the network.
+
+    Postcondition: Returns a handle that keeps the current version alive.
+-----------------------------------------------------------------------*/
+SocialGraph::Snapshot SocialGraph::snapshot() const {
+    return Snapshot(atomic_load(&current));
+}
+
+/*-----------------------------------------------------------------------
+    Read operations of the live graph.
+
+    Each one pins the current version and runs the Snapshot operation of
+    the same name on it, so one call never sees a half-applied write.
+-----------------------------------------------------------------------*/
+bool SocialGraph::areConnected(const string& name1, const string& name2) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).areConnected(name1, name2);
+}
+
+vector<string> SocialGraph::recommendFriends(const string& name, int k) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).recommendFriends(name, k);
+}
+
+vector<string> SocialGraph::recommendFriends(const string& name, int k, const RecommendOptions& options) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).recommendFriends(name, k, options);
+}
+
+vector<string> SocialGraph::shortestPath(const string& from, const string& to) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).shortestPath(from, to);
+}
+
+vector<string> SocialGraph::shortestPathAvoiding(const string& from, const string& to, const vector<string>& blacklist) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).shortestPathAvoiding(from, to, blacklist);
+}
+
+SocialGraph::PathResult SocialGraph::shortestPath(const string& from, const string& to,
+                                                  const SearchLimits& limits) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).shortestPath(from, to, limits);
+}
+
+SocialGraph::PathResult SocialGraph::shortestPathAvoiding(const string& from, const string& to,
+                                                          const vector<string>& blacklist,
+                                                          const SearchLimits& limits) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).shortestPathAvoiding(from, to, blacklist, limits);
+}
+
+vector<SocialGraph::Node> SocialGraph::getFriends(const Node& node) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).getFriends(node);
+}
+
+vector<SocialGraph::Node> SocialGraph::getNodes() const {
+    ReadGuard state(*this);
+    return Snapshot(*state).getNodes();
+}
+
+vector<SocialGraph::Edge> SocialGraph::getEdgeList() const {
+    ReadGuard state(*this);
+    return Snapshot(*state).getEdgeList();
+}
+
+vector<vector<string>> SocialGraph::shortestPaths(const vector<pair<string, string>>& queries) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).shortestPaths(queries);
+}
+
+uint64_t SocialGraph::countShortestPaths(const string& from, const string& to) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).countShortestPaths(from, to);
+}
+
+vector<vector<string>> SocialGraph::kShortestPaths(const string& from, const string& to, int k) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).kShortestPaths(from, to, k);
+}
+
+bool SocialGraph::inSameComponent(const string& name1, const string& name2) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).inSameComponent(name1, name2);
+}
+
+size_t SocialGraph::componentCount() {
+    refreshComponents();
+    ReadGuard state(*this);
+    return Snapshot(*state).componentCount();
+}
+
+vector<int> SocialGraph::componentSizes() {
+    refreshComponents();
+    ReadGuard state(*this);
+    return Snapshot(*state).componentSizes();
+}
+
+int SocialGraph::friendCount(const string& name) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).friendCount(name);
+}
+
+SocialGraph::DegreeStats SocialGraph::degreeStats() const {
+    ReadGuard state(*this);
+    return Snapshot(*state).degreeStats();
+}
+
+SocialGraph::DegreeStats SocialGraph::degreeStats(int topCount, const vector<double>& percentiles) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).degreeStats(topCount, percentiles);
+}
+
+/*-----------------------------------------------------------------------
+    Rebuild the components if removals left them stale.
+
+    Postcondition: The current version has exact components, unless a
+                  removal was published since.
+-----------------------------------------------------------------------*/
+void SocialGraph::refreshComponents() {
+    {
+        ReadGuard state(*this);
+        if (state->componentsExact) return;
+    }
+
+    // Only the component arrays change, so no shard has to be locked.
+    // Removals in a row cost one rebuild, at the first query after them.
+    PendingWrite write;
+    write.apply = [](State& state) {
+        if (state.componentsExact) return false;   // Another caller rebuilt them
+        rebuildComponents(state);
+        return true;
+    };
+    commit(write);
+}
+
+bool SocialGraph::saveToFile(const string& edgeListFile) const {
+    ReadGuard state(*this);
+    return Snapshot(*state).saveToFile(edgeListFile);
+}
+
+/*-----------------------------------------------------------------------
+    Snapshot getters.
+
+    Postcondition: Each one reads the version held by the snapshot.
+-----------------------------------------------------------------------*/
+uint64_t SocialGraph::Snapshot::version() const {
+    return state->version;
+}
+
+size_t SocialGraph::Snapshot::personCount() const {
+    return state->personCount;
+}
+
+size_t SocialGraph::Snapshot::friendshipCount() const {
+    return state->friendshipCount;
+}
+
+int SocialGraph::Snapshot::findId(string_view name) const {
+    return state->findId(name);
+}
+
+int SocialGraph::Snapshot::nodeCount() const {
+    return state->people.size();
+}
+
+bool SocialGraph::Snapshot::isPerson(int id) const {
+    return state->person(id) != nullptr;
+}
+
+string_view SocialGraph::Snapshot::nameOf(int id) const {
+    const Person* person = state->person(id);
+    return person ? person->name : string_view();
+}
+
+SocialGraph::FriendRange SocialGraph::Snapshot::neighbors(int id) const {
+    const Person* person = state->person(id);
+    return FriendRange(person ? &person->friends : nullptr);
+}
+
+int SocialGraph::Snapshot::degree(int id) const {
+    const Person* person = state->person(id);
+    return person ? (int)person->friends.size() : 0;
+}
+
+/*-----------------------------------------------------------------------
+    Look up the node ID of a person in one version.
+
+    Precondition:  name is the person to find.
+    Postcondition: Returns the node ID, or -1 if name is not present.
+-----------------------------------------------------------------------*/
+int SocialGraph::State::findId(string_view name) const {
+    int bucket = (int)(hash<string_view>()(name) & (nameIndex.size() - 1));
+    const shared_ptr<const NameBucket>& entries = nameIndex[bucket];
+    if (!entries) return -1;
+    for (const pair<string_view, int>& entry : entries->entries) {
+        if (entry.first == name) return entry.second;
+    }
+    return -1;
+}
+
+/*-----------------------------------------------------------------------
+    Check if two node IDs are friends.
+
+    Precondition:  a and b are node IDs of people in this version.
+    Postcondition: Returns true if an edge connects a and b, false otherwise.
+-----------------------------------------------------------------------*/
+bool SocialGraph::State::hasFriend(int a, int b) const {
+    // Scan the shorter of the two friend lists
+    const ChunkedArray<int>* friends = &person(a)->friends;
+    if (friends->size() > person(b)->friends.size()) {
+        friends = &person(b)->friends;
+        b = a;
+    }
+    return find(friends->begin(), friends->end(), b) != friends->end();
+}
+
+/*-----------------------------------------------------------------------
+    Find the union-find root of a node ID.
+
+    Precondition:  id is in [0, people.size()).
+    Postcondition: Returns the root; the version is not changed.
+-----------------------------------------------------------------------*/
+int SocialGraph::State::componentRoot(int id) const {
+    // Union by size keeps the walk to O(log n) parents
+    while (componentParent[id] != id) {
+        id = componentParent[id];
+    }
+    return id;
+}
+
+/*-----------------------------------------------------------------------
+    Remove one node ID from a friend list.
+
+    Precondition:  friends is a friend list; token identifies the writer.
+    Postcondition: The first occurrence of id is replaced by the last
+                  friend, which is then dropped. Closing the gap instead
+                  would copy every chunk after it.
+-----------------------------------------------------------------------*/
+void SocialGraph::eraseFriend(ChunkedArray<int>& friends, int id, uint64_t token) {
+    int i = 0;
+    for (int friendId : friends) {
+        if (friendId == id) break;
+        i++;
+    }
+    if (i == friends.size()) return;
+    int last = friends.size() - 1;
+    if (i != last) friends.assign(i, friends[last], token);
+    friends.removeLast(token);
+}
+
+/*-----------------------------------------------------------------------
+    Find the union-find root of a node ID while building a version.
+
+    Precondition:  state has not been published.
+    Postcondition: Returns the root. Every other parent on the way now
+                  points to its grandparent.
+-----------------------------------------------------------------------*/
+int SocialGraph::findComponent(State& state, int id) {
+    while (state.componentParent[id] != id) {
+        int parent = state.componentParent[id];
+        int grandparent = state.componentParent[parent];
+        if (grandparent != parent) {
+            state.componentParent.assign(id, grandparent, state.version);
         }
+        id = grandparent;
     }
+    return id;
+}
+
+/*-----------------------------------------------------------------------
+    Merge the union-find classes of two node IDs.
 
-    return path;
+    Precondition:  state has not been published.
+    Postcondition: a and b have the same root.
+-----------------------------------------------------------------------*/
+void SocialGraph::joinComponents(State& state, int a, int b) {
+    int rootA = findComponent(state, a), rootB = findComponent(state, b);
+    if (rootA == rootB) return;
+
+    int sizeA = state.componentSize[rootA], sizeB = state.componentSize[rootB];
+    if (sizeA < sizeB) {
+        swap(rootA, rootB);
+    }
+    state.componentParent.assign(rootB, rootA, state.version);
+    state.componentSize.assign(rootA, sizeA + sizeB, state.version);
+    state.componentCount--;
 }
 
 /*-----------------------------------------------------------------------
-    Check if a node exists in the graph.
+    Recompute the components of a version from its friend lists.
 
-    Precondition:  node is the node to check.
-    Postcondition: Returns true if node exists in the graph, false otherwise.
+    Precondition:  state has not been published.
+    Postcondition: Each component is one class rooted at its first node
+                  ID; removed IDs are roots of their own with size 0.
 -----------------------------------------------------------------------*/
-bool SocialGraph::nodeExists(const Node& node) const {
-    return find(nodes.begin(), nodes.end(), node) != nodes.end();
+void SocialGraph::rebuildComponents(State& state) {
+    int count = state.people.size();
+    vector<int> parent(count, -1), size(count, 0);
+    vector<int> queue;
+    state.componentCount = 0;
+    for (int id = 0; id < count; id++) {
+        if (parent[id] != -1) continue;
+        parent[id] = id;
+        if (!state.person(id)) continue;
+
+        state.componentCount++;
+        queue.assign(1, id);
+        for (size_t head = 0; head < queue.size(); head++) {
+            for (int friendId : state.person(queue[head])->friends) {
+                if (parent[friendId] == -1) {
+                    parent[friendId] = id;
+                    queue.push_back(friendId);
+                }
+            }
+        }
+        size[id] = (int)queue.size();
+    }
+
+    // Fresh arrays, so nothing is shared with earlier versions
+    PersistentArray<int> newParent, newSize;
+    for (int id = 0; id < count; id++) {
+        newParent.append(parent[id], state.version);
+        newSize.append(size[id], state.version);
+    }
+    state.componentParent = newParent;
+    state.componentSize = newSize;
+    state.componentsExact = true;
 }
 
 /*-----------------------------------------------------------------------
@@ -382,19 +1374,42 @@ bool SocialGraph::nodeExists(const Node& node) const {
     Precondition:  node is a valid node in the graph.
     Postcondition: Returns a vector of nodes that are friends with the given node.
 -----------------------------------------------------------------------*/
-vector<SocialGraph::Node> SocialGraph::getFriends(const Node& node) const {
+vector<SocialGraph::Node> SocialGraph::Snapshot::getFriends(const Node& node) const {
     vector<Node> friends;
-    for (const Edge& edge : edgeList) {
-        if (edge.getFirstNode() == node) {
-            friends.push_back(edge.getSecondNode());
-        }
-        else if (edge.getSecondNode() == node) {
-            friends.push_back(edge.getFirstNode());
-        }
-    }
+    forEachFriend(node.getName(), [&friends](string_view name) {
+        friends.push_back(Node(string(name)));
+    });
     return friends;
 }
 
+/*-----------------------------------------------------------------------
+    Get all people in the network.
+
+    Postcondition: Returns a vector of all nodes, in the order they were added.
+-----------------------------------------------------------------------*/
+vector<SocialGraph::Node> SocialGraph::Snapshot::getNodes() const {
+    vector<Node> people;
+    people.reserve(state->personCount);
+    forEachPerson([&people](string_view name) {
+        people.push_back(Node(string(name)));
+    });
+    return people;
+}
+
+/*-----------------------------------------------------------------------
+    Get all friendships in the network.
+
+    Postcondition: Returns a vector with one edge per friendship.
+-----------------------------------------------------------------------*/
+vector<SocialGraph::Edge> SocialGraph::Snapshot::getEdgeList() const {
+    vector<Edge> edges;
+    edges.reserve(state->friendshipCount);
+    forEachEdge([&edges](string_view a, string_view b) {
+        edges.push_back(Edge(Node(string(a)), Node(string(b))));
+    });
+    return edges;
+}
+
 
 
 /*-----------------------------------------------------------------------
@@ -411,9 +1426,11 @@ bool SocialGraph::loadFromFile(const string& edgeListFile) {
         return false;
     }
 
-    // Clear existing graph data before loading new data
-    nodes.clear();
-    edgeList.clear();
+    // Build the new network in a version of its own, starting empty and
+    // without any lock held. It is edited under token 0, which no version
+    // built by beginWrite() uses. Readers keep seeing the old network
+    // until it is published.
+    shared_ptr<State> next = emptyState(0);
 
     string line;
     while (getline(inFile, line)) {
@@ -427,17 +1444,28 @@ bool SocialGraph::loadFromFile(const string& edgeListFile) {
         sourceName.erase(0, sourceName.find_first_not_of(" \t"));
         sourceName.erase(sourceName.find_last_not_of(" \t") + 1);
 
-        addPerson(sourceName);
+        applyAddPerson(*next, sourceName);
 
         // Process all friends listed after the colon
         istringstream iss(line.substr(colonPos + 1));
         string neighbor;
         while (iss >> neighbor) {
-            addPerson(neighbor);
-            addFriend(sourceName, neighbor);  // Create undirected connection
+            applyAddPerson(*next, neighbor);
+            applyAddFriend(*next, sourceName, neighbor);  // Create undirected connection
         }
     }
 
+    // Edge writers still working on records of the old network must
+    // finish first, then the whole network is replaced in one version
+    vector<unique_lock<mutex>> locks = lockAllShards();
+    PendingWrite write;
+    write.apply = [&next](State& state) {
+        uint64_t version = state.version;
+        state = *next;
+        state.version = version;
+        return true;
+    };
+    commit(write);
     return true;
 }
 
@@ -449,7 +1477,7 @@ bool SocialGraph::loadFromFile(const string& edgeListFile) {
     Postcondition: Graph data is written to the file.
                   Returns true if successful, false otherwise.
 -----------------------------------------------------------------------*/
-bool SocialGraph::saveToFile(const string& edgeListFile) const {
+bool SocialGraph::Snapshot::saveToFile(const string& edgeListFile) const {
     ofstream outFile(edgeListFile);
     if (!outFile) {
         cerr << "Error: Could not open file for writing: " << edgeListFile << endl;
@@ -457,21 +1485,23 @@ bool SocialGraph::saveToFile(const string& edgeListFile) const {
     }
 
     // Save in format "source: n1 n2 n3"
-    vector<Node> nodes = getNodes();
-    for (const Node& current : nodes) {
-        outFile << current.getName() << ": ";
+    const State& version = *state;
+    version.people.forEach([&version, &outFile](int, const shared_ptr<const Person>& current) {
+        if (!current) return;
+        outFile << current->name << ": ";
 
         // Loop through each friend to write their name to file
-        vector<Node> friends = getFriends(current);
-        for (int j = 0; j < friends.size(); j++) {
-            outFile << friends[j].getName();
-            if (j != friends.size() - 1) {
+        bool first = true;
+        for (int friendId : current->friends) {
+            if (!first) {
                 // Space between names, no trailing space
-                outFile << " ";  
+                outFile << " ";
             }
+            outFile << version.person(friendId)->name;
+            first = false;
         }
         outFile << endl;
-    }
+    });
 
     return true;
-}
\ No newline at end of file
+}
@@ -4,17 +4,59 @@
  * Description: Represents a social network using graph data structure to
  *              store people and their friendship connections.
  *
+ *              Every person gets an integer node ID when added. Names live
+ *              in a single arena and are only copied into std::string at the
+ *              public API boundary; internal algorithms work on node IDs.
+ *
+ *              The network is published as a series of immutable versions
+ *              (read-copy-update). Readers work on whichever version was
+ *              current when they started and never take a lock: a thread
+ *              announces the version it is reading in a hazard slot of its
+ *              own instead of touching the shared reference count. Writers
+ *              copy just the parts of the version they change, publish the
+ *              result with one atomic pointer swap and free the versions
+ *              they replaced once no thread announces them any more.
+ *
+ *              Writers are split into shards by node ID. A friendship change
+ *              only locks the shards of its two people and builds their new
+ *              records alongside other writers; the finished changes are
+ *              then published together, by whichever writer gets the publish
+ *              lock first, so both ends of an edge appear in the same
+ *              version. Adding people needs no shard, while removing a
+ *              person or loading a file locks them all.
+ *
+ *              snapshot() hands out a Snapshot: a cheap, immutable handle on
+ *              one version that offers the whole read API. Versions share
+ *              every unchanged tree node and friend list chunk, so a new
+ *              friendship copies one chunk of 64 friend IDs per person
+ *              rather than their whole list, and a version is freed as
+ *              soon as its last handle is dropped.
+ *
  * Member Variables:
- *    - nodes: Vector storing all people in the network (vertices)
- *    - edgeList: Vector storing all friendship connections (edges)
+ *    - current: Latest published version of the network
+ *    - published: current, readable without the reference count
+ *    - retired: Replaced versions that a reader may still be using
+ *    - shards: Writer locks, one per group of node IDs
+ *    - publishMutex: Held while a batch of changes is published
+ *    - pending: Changes waiting to be published
+ *    - pendingMutex: Guards pending
  *
  *****************************************************************************/
 
 #ifndef SOCIALGRAPH_H
 #define SOCIALGRAPH_H
 
+#include "ChunkedArray.h"
+#include "NameArena.h"
+#include "PersistentArray.h"
 #include <vector>
 #include <string>
+#include <string_view>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <cstdint>
 #include <fstream>
 
 using namespace std;
@@ -97,6 +139,230 @@ public:
          ------------------------------------------------------------------*/
     };
 
+    /***** NeighborRange Class (Non-owning view of a CSR friend list) *****/
+    class NeighborRange {
+        const int* first;
+        const int* last;
+    public:
+        /*** Constructer ***/
+        NeighborRange(const int* first = nullptr, const int* last = nullptr)
+            : first(first), last(last) {}
+        /*-------------------------------------------------------------------
+          Construct a view over the node IDs in [first, last).
+
+          Precondition:  first and last delimit a friend list owned by a graph.
+          Postcondition: A view is created; nothing is copied.
+         ------------------------------------------------------------------*/
+
+        /*** Getters **/
+        const int* begin() const { return first; }
+        const int* end() const { return last; }
+        int size() const { return (int)(last - first); }
+        bool empty() const { return first == last; }
+        int operator[](int i) const { return first[i]; }
+        /*-------------------------------------------------------------------
+          Iterate over or index into the friend IDs.
+
+          Precondition:  The GraphSnapshot the view was taken from is still
+                         alive.
+          Postcondition: The friend IDs are read in place.
+         ------------------------------------------------------------------*/
+    };
+
+    /***** FriendRange Class (Non-owning view of a friend list of a version) *****/
+    class FriendRange {
+        const ChunkedArray<int>* friends;
+    public:
+        /*** Constructer ***/
+        explicit FriendRange(const ChunkedArray<int>* friends = nullptr) : friends(friends) {}
+        /*-------------------------------------------------------------------
+          Construct a view over a friend list, or an empty view.
+
+          Precondition:  friends belongs to a version of a graph.
+          Postcondition: A view is created; nothing is copied.
+         ------------------------------------------------------------------*/
+
+        /*** Getters **/
+        ChunkedArray<int>::Iterator begin() const { return friends ? friends->begin() : ChunkedArray<int>::Iterator(); }
+        ChunkedArray<int>::Iterator end() const { return ChunkedArray<int>::Iterator(); }
+        int size() const { return friends ? friends->size() : 0; }
+        bool empty() const { return size() == 0; }
+        int operator[](int i) const { return (*friends)[i]; }
+        /*-------------------------------------------------------------------
+          Iterate over or index into the friend IDs.
+
+          Precondition:  The Snapshot the view was taken from (or a copy of
+                         it) is still alive.
+          Postcondition: The friend IDs are read in place, one chunk at a
+                         time; indexing costs O(log32 n).
+         ------------------------------------------------------------------*/
+    };
+
+    /***** Mutation Struct (one change, applied as part of a batch) *****/
+    struct Mutation {
+        enum Kind { AddPerson, RemovePerson, AddFriend, RemoveFriend };
+        Kind kind;
+        string name1;
+        string name2;   // Only used by AddFriend and RemoveFriend
+    };
+
+    /***** Search Limits Struct (caps on one path search) *****/
+    struct SearchLimits {
+        int maxDepth = -1;          // Longest path looked for, in hops; -1 for no limit
+        int maxVisitedNodes = -1;   // People visited before giving up; -1 for no limit
+    };
+
+    /***** Path Result Struct (outcome of a limited path search) *****/
+    struct PathResult {
+        vector<string> path;        // Names from start to end; empty if none was found
+        bool exhaustive = true;     // False if a limit stopped the search early
+    };
+
+    /***** Recommend Options Struct (how friend recommendations are ranked) *****/
+    struct RecommendOptions {
+        enum Strategy { MutualFriends, PersonalizedPageRank };
+        Strategy strategy = MutualFriends;
+        double alpha = 0.15;        // Restart chance of the random walk (PageRank only)
+        double epsilon = 1e-6;      // Residual threshold; smaller is finer and slower (PageRank only)
+        int64_t budgetMicros = -1;  // Time allowed for the pushes; -1 for no limit (PageRank only)
+    };
+
+    /***** Degree Stats Struct (friend counts across the network) *****/
+    struct DegreeStats {
+        vector<int> histogram;          // Element d is the number of people with d friends
+        vector<int> percentiles;        // Friend count at each requested percentile
+        vector<pair<string, int>> top;  // Names and friend counts, most friends first
+        double mean = 0.0;              // Average friends per person
+    };
+
+private:
+    struct Person;
+    struct State;
+
+public:
+    /***** Snapshot Class (Immutable handle on one version of the network) *****/
+    class Snapshot {
+        shared_ptr<const State> owner;  // Keeps the version alive (null when borrowed)
+        const State* state;             // The version being read
+    public:
+        /*** Getters **/
+        uint64_t version() const;
+        /*-------------------------------------------------------------------
+          Get the version number of this snapshot.
+
+          Postcondition: Later versions of the same graph have larger numbers.
+         ------------------------------------------------------------------*/
+
+        size_t personCount() const;
+        size_t friendshipCount() const;
+        /*-------------------------------------------------------------------
+          Get the number of people and of friendships in this version.
+         ------------------------------------------------------------------*/
+
+        /*** Read Operations **/
+        // Each one behaves like the SocialGraph function of the same name,
+        // on this version of the network.
+        bool areConnected(const string& name1, const string& name2) const;
+        vector<string> recommendFriends(const string& name, int k) const;
+        vector<string> recommendFriends(const string& name, int k, const RecommendOptions& options) const;
+        vector<string> shortestPath(const string& from, const string& to) const;
+        vector<string> shortestPathAvoiding(const string& from, const string& to,
+                                          const vector<string>& blacklist) const;
+        PathResult shortestPath(const string& from, const string& to, const SearchLimits& limits) const;
+        PathResult shortestPathAvoiding(const string& from, const string& to,
+                                        const vector<string>& blacklist, const SearchLimits& limits) const;
+        vector<vector<string>> shortestPaths(const vector<pair<string, string>>& queries) const;
+        uint64_t countShortestPaths(const string& from, const string& to) const;
+        vector<vector<string>> kShortestPaths(const string& from, const string& to, int k) const;
+        bool inSameComponent(const string& name1, const string& name2) const;
+        size_t componentCount() const;
+        vector<int> componentSizes() const;
+        int friendCount(const string& name) const;
+        DegreeStats degreeStats() const;
+        DegreeStats degreeStats(int topCount, const vector<double>& percentiles) const;
+        vector<Node> getFriends(const Node& node) const;
+        vector<Node> getNodes() const;
+        vector<Edge> getEdgeList() const;
+        bool saveToFile(const string& edgeListFile) const;
+
+        /*** Zero-copy Access **/
+        int findId(string_view name) const;
+        int nodeCount() const;
+        bool isPerson(int id) const;
+        string_view nameOf(int id) const;
+        FriendRange neighbors(int id) const;
+        int degree(int id) const;
+        /*-------------------------------------------------------------------
+          Read node IDs, names and friend lists of this version in place.
+          Node IDs range over [0, nodeCount()); removed people keep their
+          ID with no name and no friends. Friend lists are in the order
+          the friendships were made, except that removing a friend moves
+          the last one into its place. Views stay valid for as long as the
+          snapshot (or any copy of it) is alive, which makes a snapshot
+          the graph view the traversal and analytics templates run on.
+         ------------------------------------------------------------------*/
+
+        // A snapshot can't cache anything, so component statistics of a
+        // version taken after removals and before the next rebuild cost a
+        // full pass over the network.
+
+        template <class Visitor>
+        void forEachPerson(Visitor visit) const;
+        template <class Visitor>
+        void forEachFriend(const string& name, Visitor visit) const;
+        template <class Visitor>
+        void forEachEdge(Visitor visit) const;
+        /*-------------------------------------------------------------------
+          Same as the SocialGraph visitors, on this version.
+         ------------------------------------------------------------------*/
+
+    private:
+        friend class SocialGraph;
+        friend class GraphSnapshot;
+
+        PathResult searchPath(const string& from, const string& to, const vector<string>& blacklist,
+                              const SearchLimits& limits) const;
+        /*-------------------------------------------------------------------
+          Breadth-first path search shared by the shortestPath variants.
+
+          Postcondition: Returns the path and whether the search was
+                         exhaustive. Runs on the thread's workspace; an
+                         unlimited search whose frontier grows very wide
+                         starts over with the parallel BFS.
+         ------------------------------------------------------------------*/
+
+        /*** Constructers ***/
+        explicit Snapshot(shared_ptr<const State> version)
+            : owner(move(version)), state(owner.get()) {}
+        explicit Snapshot(const State& version) : state(&version) {}
+        /*-------------------------------------------------------------------
+          Hold a version, or borrow one that the caller keeps pinned.
+         ------------------------------------------------------------------*/
+    };
+
+    /*** Constructer ***/
+    explicit SocialGraph(int shardCount = 64);
+    /*-----------------------------------------------------------------------
+      Construct an empty social network.
+
+      Precondition:  shardCount > 0.
+      Postcondition: The graph holds no people and no friendships. Writers
+                     are split over shardCount locks by node ID.
+     ----------------------------------------------------------------------*/
+
+    // Readers cache versions per graph, so a graph has a fixed identity
+    SocialGraph(const SocialGraph&) = delete;
+    SocialGraph& operator=(const SocialGraph&) = delete;
+
+    Snapshot snapshot() const;
+    /*-----------------------------------------------------------------------
+      Take a consistent, read-only view of the network.
+
+      Postcondition: Returns a handle on the current version. Later changes
+                     to the graph never show up in it, and the version is
+                     freed when the last copy of the handle is destroyed.
+     ----------------------------------------------------------------------*/
+
     /***** Social Graph Operations *****/
     void addPerson(const string& name);
     /*-----------------------------------------------------------------------
@@ -133,6 +399,15 @@ public:
       Postcondition: Any edge between them is removed if found.
      ----------------------------------------------------------------------*/
 
+    vector<bool> applyBatch(const vector<Mutation>& batch);
+    /*-----------------------------------------------------------------------
+      Apply a list of changes as one new version.
+
+      Precondition:  batch holds the changes in the order to apply them.
+      Postcondition: Readers see either none or all of the changes. Element
+                     i of the result is true if batch[i] changed the graph.
+     ----------------------------------------------------------------------*/
+
     bool areConnected(const string& name1, const string& name2) const;
     /*-----------------------------------------------------------------------
       Check if two people are friends.
@@ -150,6 +425,20 @@ public:
                      number of mutual friends.
      ----------------------------------------------------------------------*/
 
+    vector<string> recommendFriends(const string& name, int k, const RecommendOptions& options) const;
+    /*-----------------------------------------------------------------------
+      Recommend friends with a chosen ranking strategy.
+
+      Precondition:  name is a valid name in the graph; k is number of recommendations.
+      Postcondition: MutualFriends behaves like recommendFriends(name, k).
+                     PersonalizedPageRank ranks the people a random walk
+                     from name (restarting with chance alpha) visits most,
+                     estimated by forward pushes whose cost depends on
+                     epsilon rather than the size of the network. Once
+                     budgetMicros has passed, the pushes stop and the
+                     estimates so far are ranked.
+     ----------------------------------------------------------------------*/
+
     vector<string> shortestPath(const string& from, const string& to) const;
     /*-----------------------------------------------------------------------
       Find shortest path between two people.
@@ -169,6 +458,96 @@ public:
                      empty if no valid path exists.
      ----------------------------------------------------------------------*/
 
+    PathResult shortestPath(const string& from, const string& to, const SearchLimits& limits) const;
+    PathResult shortestPathAvoiding(const string& from, const string& to,
+                                    const vector<string>& blacklist, const SearchLimits& limits) const;
+    /*-----------------------------------------------------------------------
+      Find a shortest path with a bounded search.
+
+      Precondition:  from and to are valid names; limits caps the depth
+                     and the number of people visited.
+      Postcondition: path is the shortest path if one within maxDepth
+                     hops was found. exhaustive is false if a limit cut
+                     the search short, in which case an empty path does
+                     not prove that no path (within maxDepth) exists.
+     ----------------------------------------------------------------------*/
+
+    vector<vector<string>> shortestPaths(const vector<pair<string, string>>& queries) const;
+    /*-----------------------------------------------------------------------
+      Find the shortest paths of many (from, to) pairs at once.
+
+      Precondition:  Each query is a pair of names.
+      Postcondition: Element i is a shortest path of query i, empty if
+                     there is none. Where several paths are shortest it
+                     may differ from the one shortestPath returns.
+                     Queries sharing a source or a target are answered by
+                     the same traversal; a handful of queries run as
+                     separate searches on the thread's workspace.
+     ----------------------------------------------------------------------*/
+
+    uint64_t countShortestPaths(const string& from, const string& to) const;
+    /*-----------------------------------------------------------------------
+      Count the distinct shortest paths between two people.
+
+      Precondition:  from and to are valid names in the graph.
+      Postcondition: Returns 0 if no path exists. Counts beyond the range
+                     of uint64_t are reported as UINT64_MAX.
+     ----------------------------------------------------------------------*/
+
+    vector<vector<string>> kShortestPaths(const string& from, const string& to, int k) const;
+    /*-----------------------------------------------------------------------
+      Find up to k different ways two people are connected.
+
+      Precondition:  from and to are valid names in the graph; k > 0.
+      Postcondition: Returns at most k distinct paths without repeated
+                     people, shortest first. All shortest paths come before
+                     the longer alternatives.
+     ----------------------------------------------------------------------*/
+
+    bool inSameComponent(const string& name1, const string& name2) const;
+    /*-----------------------------------------------------------------------
+      Check if two people are connected by any chain of friendships.
+
+      Precondition:  name1 and name2 are valid names in the graph.
+      Postcondition: Returns true if a path exists. People in different
+                     components are told apart without a search.
+     ----------------------------------------------------------------------*/
+
+    size_t componentCount();
+    vector<int> componentSizes();
+    /*-----------------------------------------------------------------------
+      Get the number and sizes of the connected components.
+
+      Postcondition: Sizes count people and are sorted largest first. If
+                     people or friendships were removed since the last
+                     call, the components are rebuilt and published first.
+     ----------------------------------------------------------------------*/
+
+    int friendCount(const string& name) const;
+    /*-----------------------------------------------------------------------
+      Get the number of friends of a person.
+
+      Precondition:  name is the person to look up.
+      Postcondition: Returns the friend count kept up to date by every
+                     change, or -1 if name is not in the graph. No friend
+                     list is read.
+     ----------------------------------------------------------------------*/
+
+    DegreeStats degreeStats() const;
+    DegreeStats degreeStats(int topCount, const vector<double>& percentiles) const;
+    /*-----------------------------------------------------------------------
+      Summarize the friend counts of the network.
+
+      Precondition:  percentiles lie in [0, 100]; without arguments they
+                     are 50, 90 and 99, with the top 10 people.
+      Postcondition: histogram has one element per friend count up to the
+                     largest. percentiles[i] is the smallest count that at
+                     least percentiles[i] percent of people don't exceed.
+                     top holds up to topCount people, ties by the order
+                     they were added. Costs one pass over the counters of
+                     one version; no friend list is read.
+     ----------------------------------------------------------------------*/
+
     vector<Node> getFriends(const Node& node) const;
     /*-----------------------------------------------------------------------
       Get all friends of a given person.
@@ -177,20 +556,93 @@ public:
       Postcondition: Returns vector of Nodes that are friends with given node.
      ----------------------------------------------------------------------*/
 
-    vector<Node> getNodes() const { return nodes; }
+    vector<Node> getNodes() const;
     /*-----------------------------------------------------------------------
       Get all people in the network.
       
       Postcondition: Returns vector of all Nodes in the graph.
      ----------------------------------------------------------------------*/
 
-    vector<Edge> getEdgeList() const { return edgeList; }
+    vector<Edge> getEdgeList() const;
     /*-----------------------------------------------------------------------
       Get all friendships in the network.
       
       Postcondition: Returns vector of all Edges in the graph.
      ----------------------------------------------------------------------*/
 
+    /***** Zero-copy Access *****/
+    // Names and friend lists are only handed out as views by a Snapshot:
+    // the live graph could free them with the next write
+    int findId(string_view name) const;
+    /*-----------------------------------------------------------------------
+      Look up the node ID of a person.
+
+      Precondition:  name is the person to find.
+      Postcondition: Returns the node ID, or -1 if name is not in the graph.
+     ----------------------------------------------------------------------*/
+
+    int nodeCount() const { return ReadGuard(*this)->people.size(); }
+    /*-----------------------------------------------------------------------
+      Get the size of the node ID space.
+
+      Postcondition: Node IDs range over [0, nodeCount()). IDs of removed
+                     people stay in the range with no name and no friends.
+     ----------------------------------------------------------------------*/
+
+    bool isPerson(int id) const { return ReadGuard(*this)->person(id) != nullptr; }
+    /*-----------------------------------------------------------------------
+      Check if a node ID belongs to a person in the network.
+
+      Precondition:  id is in [0, nodeCount()).
+      Postcondition: Returns false if the person was removed.
+     ----------------------------------------------------------------------*/
+
+    int degree(int id) const { return Snapshot(*ReadGuard(*this)).degree(id); }
+    /*-----------------------------------------------------------------------
+      Get the number of friends of a node ID.
+
+      Precondition:  id is in [0, nodeCount()).
+      Postcondition: Returns 0 if the person was removed.
+     ----------------------------------------------------------------------*/
+
+    template <class Visitor>
+    void forEachPerson(Visitor visit) const {
+        ReadGuard state(*this);
+        Snapshot(*state).forEachPerson(visit);
+    }
+    /*-----------------------------------------------------------------------
+      Visit every person in the network.
+
+      Precondition:  visit can be called as visit(string_view name).
+      Postcondition: visit is called once per person, in the order they
+                     were added.
+     ----------------------------------------------------------------------*/
+
+    template <class Visitor>
+    void forEachFriend(const string& name, Visitor visit) const {
+        ReadGuard state(*this);
+        Snapshot(*state).forEachFriend(name, visit);
+    }
+    /*-----------------------------------------------------------------------
+      Visit every friend of a person.
+
+      Precondition:  visit can be called as visit(string_view friendName).
+      Postcondition: visit is called once per friend of name, nothing is
+                     called if name is not in the graph.
+     ----------------------------------------------------------------------*/
+
+    template <class Visitor>
+    void forEachEdge(Visitor visit) const {
+        ReadGuard state(*this);
+        Snapshot(*state).forEachEdge(visit);
+    }
+    /*-----------------------------------------------------------------------
+      Visit every friendship in the network.
+
+      Precondition:  visit can be called as visit(string_view, string_view).
+      Postcondition: visit is called once per friendship.
+     ----------------------------------------------------------------------*/
+
     bool loadFromFile(const string& edgeListFile);
     /*-----------------------------------------------------------------------
       Load network from a file.
@@ -211,26 +663,269 @@ public:
      ----------------------------------------------------------------------*/
 
 private:
+    friend class GraphSnapshot;  // Reads the current version when freezing
+
+    /***** Person Record (never changed once published) *****/
+    struct Person {
+        uint64_t owner = 0;         // Version that may still edit it in place
+        string_view name;           // View into the arena
+        ChunkedArray<int> friends;  // Friend IDs, in chunks shared between versions
+    };
+
+    /***** Name Bucket (one hash bucket of the name index) *****/
+    struct NameBucket {
+        uint64_t owner = 0;                         // Version that may still edit it
+        vector<pair<string_view, int>> entries;     // Name -> node ID
+    };
+
+    /***** State Struct (one immutable version of the network) *****/
+    struct State {
+        shared_ptr<NameArena> arena;                                // Shared by versions
+        PersistentArray<shared_ptr<const Person>> people;           // Null once removed
+        PersistentArray<shared_ptr<const NameBucket>> nameIndex;    // Hash buckets
+        size_t personCount = 0;                                     // Living people
+        size_t friendshipCount = 0;                                 // Edges
+        uint64_t version = 0;                                       // Publication number
+        PersistentArray<int> componentParent;                       // Union-find parent of each node ID
+        PersistentArray<int> componentSize;                         // People under each root
+        size_t componentCount = 0;                                  // Roots holding people
+        bool componentsExact = true;                                // False after a removal until rebuilt
+        PersistentArray<int> degreeCounts;                          // Element d counts people with d friends
+
+        const Person* person(int id) const { return people[id].get(); }
+        /*-------------------------------------------------------------------
+          Get the record of a node ID.
+
+          Precondition:  id is in [0, people.size()).
+          Postcondition: Returns null if the person was removed.
+         ------------------------------------------------------------------*/
+
+        int findId(string_view name) const;
+        /*-------------------------------------------------------------------
+          Look up the node ID of a person.
+
+          Precondition:  name is the person to find.
+          Postcondition: Returns the node ID, or -1 if name is not present.
+         ------------------------------------------------------------------*/
+
+        bool hasFriend(int a, int b) const;
+        /*-------------------------------------------------------------------
+          Check if two node IDs are friends.
+
+          Precondition:  a and b are node IDs of people in this version.
+          Postcondition: Returns true if an edge connects a and b.
+         ------------------------------------------------------------------*/
+
+        int componentRoot(int id) const;
+        /*-------------------------------------------------------------------
+          Find the union-find root of a node ID, without compressing.
+
+          Precondition:  id is in [0, people.size()).
+          Postcondition: People with different roots are not connected. If
+                         componentsExact, people with the same root are.
+         ------------------------------------------------------------------*/
+    };
+
+    /***** ReadGuard Class (Pins a version for the length of a read) *****/
+    class ReadGuard {
+        shared_ptr<const State> pinned;   // Only used when the hazard slot can't be
+        const State* state;
+    public:
+        explicit ReadGuard(const SocialGraph& graph);
+        ~ReadGuard();
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        /*-------------------------------------------------------------------
+          Pin the current version of graph.
+
+          Postcondition: The version stays alive and unchanged until the
+                         guard is destroyed. No lock is taken, and the
+                         outermost guard of a thread only writes the
+                         thread's own hazard slot.
+         ------------------------------------------------------------------*/
+
+        const State* operator->() const { return state; }
+        const State& operator*() const { return *state; }
+    };
+
+    /***** Shard (writer lock of one group of node IDs) *****/
+    struct alignas(64) Shard {
+        mutex lock;                 // Own cache line, so shards don't contend
+    };
+
+    /***** Pending Write (one change waiting to be published) *****/
+    struct PendingWrite {
+        function<bool(State&)> apply;   // Makes the change on the version being built
+        bool changed = false;           // Result of apply
+        bool done = false;              // Set under publishMutex once applied
+    };
+
     /***** Data Members *****/
-    vector<Node> nodes;      // All people in the network
-    vector<Edge> edgeList;   // All friendships in the network
+    shared_ptr<const State> current;        // Only accessed with atomic_load/store
+    atomic<const State*> published;         // current.get()
+    vector<shared_ptr<const State>> retired; // Guarded by publishMutex
+    vector<Shard> shards;                   // Node ID i belongs to shard i % size
+    mutex publishMutex;                     // Held while publishing
+    vector<PendingWrite*> pending;          // Queued by writers, drained by the publisher
+    mutex pendingMutex;                     // Guards pending
 
     /***** Helper Functions *****/
-    bool nodeExists(const Node& node) const;
+    shared_ptr<State> beginWrite() const;
     /*-----------------------------------------------------------------------
-      Check if a node exists in the graph.
-      
-      Precondition:  node is the Node to check.
-      Postcondition: Returns true if node exists in the graph, false otherwise.
+      Start building the next version.
+
+      Precondition:  publishMutex is held.
+      Postcondition: Returns a copy of the current version that shares all
+                     of its data and carries the next version number.
      ----------------------------------------------------------------------*/
 
-    int countMutualFriends(const Node& a, const Node& b) const;
+    void publish(shared_ptr<State> next);
     /*-----------------------------------------------------------------------
-      Count mutual friends between two people.
-      
-      Precondition:  a and b are valid Nodes in the graph.
-      Postcondition: Returns number of nodes connected to both a and b.
+      Make a version visible to readers.
+
+      Precondition:  publishMutex is held; next came from beginWrite().
+      Postcondition: New reads see next; reads already running keep the
+                     version they started with. Replaced versions that no
+                     read is using any more are released. A version whose
+                     last read ends later is only freed by the next
+                     publish, so without further writes it stays alive.
+     ----------------------------------------------------------------------*/
+
+    void commit(PendingWrite& write);
+    /*-----------------------------------------------------------------------
+      Apply a change to the next version and publish it.
+
+      Precondition:  The caller holds the shards of every record that
+                     write.apply replaces without reading the version.
+      Postcondition: write.changed holds the result of write.apply. The
+                     change may be published together with the changes of
+                     other writers that were waiting at the same time.
+     ----------------------------------------------------------------------*/
+
+    bool changeFriendship(string_view name1, string_view name2, bool add);
+    /*-----------------------------------------------------------------------
+      Add or remove a friendship, locking only the shards of the two people.
+
+      Postcondition: Returns true if the friendship was added or removed.
+     ----------------------------------------------------------------------*/
+
+    void refreshComponents();
+    /*-----------------------------------------------------------------------
+      Rebuild and publish the components if removals left them stale.
+     ----------------------------------------------------------------------*/
+
+    size_t shardOf(int id) const { return (size_t)id % shards.size(); }
+    vector<unique_lock<mutex>> lockAllShards();
+    /*-----------------------------------------------------------------------
+      Find the shard of a node ID, or lock every shard in index order.
+     ----------------------------------------------------------------------*/
+
+    static shared_ptr<State> emptyState(uint64_t version);
+    /*-----------------------------------------------------------------------
+      Create a version holding no people, with a fresh name arena.
+     ----------------------------------------------------------------------*/
+
+    static bool applyAddPerson(State& state, string_view name);
+    static bool applyRemovePerson(State& state, string_view name);
+    static bool applyAddFriend(State& state, string_view name1, string_view name2);
+    static bool applyRemoveFriend(State& state, string_view name1, string_view name2);
+    /*-----------------------------------------------------------------------
+      Apply one change to a version that is still being built.
+
+      Precondition:  state came from beginWrite() or emptyState() and has
+                     not been published.
+      Postcondition: Returns true if state changed.
+     ----------------------------------------------------------------------*/
+
+    static Person& editPerson(State& state, int id);
+    /*-----------------------------------------------------------------------
+      Get a person record of an unpublished version for writing.
+
+      Precondition:  id is a living person of state.
+      Postcondition: The record is copied first unless state already owns it.
+     ----------------------------------------------------------------------*/
+
+    static NameBucket& editBucket(State& state, int bucket);
+    /*-----------------------------------------------------------------------
+      Get a name index bucket of an unpublished version for writing.
+
+      Precondition:  bucket is in [0, state.nameIndex.size()).
+      Postcondition: The bucket is copied first unless state already owns it.
+     ----------------------------------------------------------------------*/
+
+    static void growIndex(State& state);
+    /*-----------------------------------------------------------------------
+      Double the number of name index buckets.
+
+      Postcondition: Every name is rehashed into the new buckets.
+     ----------------------------------------------------------------------*/
+
+    static void recountDegree(State& state, int degree, int change);
+    /*-----------------------------------------------------------------------
+      Move a person to another friend count while building a version.
+
+      Precondition:  state has not been published; a person with degree
+                     friends is gaining change friends.
+      Postcondition: degreeCounts agrees with the new count.
+     ----------------------------------------------------------------------*/
+
+    static int findComponent(State& state, int id);
+    static void joinComponents(State& state, int a, int b);
+    /*-----------------------------------------------------------------------
+      Find (halving the path) or merge union-find classes while building a
+      version.
+
+      Precondition:  state has not been published.
+      Postcondition: joinComponents hangs the smaller class under the larger.
+     ----------------------------------------------------------------------*/
+
+    static void rebuildComponents(State& state);
+    /*-----------------------------------------------------------------------
+      Recompute the components of a version from its friend lists.
+
+      Precondition:  state has not been published.
+      Postcondition: Every class is one connected component and
+                     componentsExact is true.
+     ----------------------------------------------------------------------*/
+
+    static void eraseFriend(ChunkedArray<int>& friends, int id, uint64_t token);
+    /*-----------------------------------------------------------------------
+      Remove one node ID from a friend list.
+
+      Precondition:  friends is a friend list; token identifies the writer.
+      Postcondition: The first occurrence of id is replaced by the last
+                     friend, so only two chunks are copied.
      ----------------------------------------------------------------------*/
 };
 
-#endif
\ No newline at end of file
+/*-----------------------------------------------------------------------
+    Snapshot visitors, defined once State is complete.
+-----------------------------------------------------------------------*/
+template <class Visitor>
+void SocialGraph::Snapshot::forEachPerson(Visitor visit) const {
+    state->people.forEach([&visit](int, const shared_ptr<const Person>& person) {
+        if (person) visit(person->name);
+    });
+}
+
+template <class Visitor>
+void SocialGraph::Snapshot::forEachFriend(const string& name, Visitor visit) const {
+    int id = state->findId(name);
+    if (id == -1) return;
+    for (int friendId : state->person(id)->friends) {
+        visit(state->person(friendId)->name);
+    }
+}
+
+template <class Visitor>
+void SocialGraph::Snapshot::forEachEdge(Visitor visit) const {
+    const State& version = *state;
+    version.people.forEach([&visit, &version](int id, const shared_ptr<const Person>& person) {
+        if (!person) return;
+        for (int friendId : person->friends) {
+            if (id < friendId) visit(person->name, version.person(friendId)->name);
+        }
+    });
+}
+
+#endif
@@ -0,0 +1,67 @@
+/******************************************************************************
+ * Class: ThreadBarrier
+ *
+ * Description: Reusable barrier for a fixed group of threads working in
+ *              lockstep (one BFS level, one round of a parallel build). The
+ *              last thread to arrive runs a completion step before the
+ *              others are released, which is where per-round results are
+ *              merged. Waiting threads spin and yield rather than sleep,
+ *              as rounds are expected to be short.
+ *
+ * Member Variables:
+ *    - arrived: Threads waiting in the current phase
+ *    - phase: Number of completed phases
+ *    - count: Threads in the group
+ *
+ *****************************************************************************/
+
+#ifndef THREADBARRIER_H
+#define THREADBARRIER_H
+
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+class ThreadBarrier {
+public:
+    /*** Constructer ***/
+    explicit ThreadBarrier(int count) : arrived(0), phase(0), count(count) {}
+    /*-------------------------------------------------------------------
+      Create a barrier for a group of threads.
+
+      Precondition:  count > 0.
+     ------------------------------------------------------------------*/
+
+    template <class Completion>
+    void arriveAndWait(Completion complete) {
+        int current = phase.load(memory_order_acquire);
+        if (arrived.fetch_add(1, memory_order_acq_rel) + 1 == count) {
+            // Last one in: finish the phase, then release the rest
+            complete();
+            arrived.store(0, memory_order_relaxed);
+            phase.store(current + 1, memory_order_release);
+        }
+        else {
+            while (phase.load(memory_order_acquire) == current) {
+                this_thread::yield();
+            }
+        }
+    }
+    /*-------------------------------------------------------------------
+      Wait for every thread of the group.
+
+      Postcondition: complete() ran once, on the last thread to arrive,
+                     after every thread arrived and before any returned.
+                     Writes made before arriving are visible to it, and
+                     its writes are visible to every thread afterwards.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    atomic<int> arrived;
+    atomic<int> phase;
+    int count;
+};
+
+#endif
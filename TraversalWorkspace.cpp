@@ -0,0 +1,74 @@
+/*-------------------------------------------------------------------------
+  TraversalWorkspace.cpp
+
+  - Implementation of all functions mentioned in TraversalWorkspace.h
+------------------------------------------------------------------------*/
+#include "TraversalWorkspace.h"
+#include <algorithm>
+
+using namespace std;
+
+/*-----------------------------------------------------------------------
+    Return a leased workspace to the calling thread's pool.
+
+    Postcondition: The workspace can be handed out again.
+-----------------------------------------------------------------------*/
+TraversalWorkspace::Lease::~Lease() {
+    if (workspace != nullptr) {
+        pool().emplace_back(workspace);
+    }
+}
+
+/*-----------------------------------------------------------------------
+    Take a workspace from the calling thread's pool.
+
+    Precondition:  nodeCount is the size of the node ID space to traverse.
+    Postcondition: Returns a lease on a workspace ready for a new traversal.
+-----------------------------------------------------------------------*/
+TraversalWorkspace::Lease TraversalWorkspace::acquire(int nodeCount) {
+    vector<unique_ptr<TraversalWorkspace>>& idle = pool();
+    TraversalWorkspace* workspace;
+    if (idle.empty()) {
+        // Only nested traversals need more than one workspace per thread
+        workspace = new TraversalWorkspace();
+    }
+    else {
+        workspace = idle.back().release();
+        idle.pop_back();
+    }
+    workspace->reset(nodeCount);
+    return Lease(workspace);
+}
+
+/*-----------------------------------------------------------------------
+    Start a new traversal.
+
+    Precondition:  nodeCount is the size of the node ID space.
+    Postcondition: No node is visited and the queue is empty.
+-----------------------------------------------------------------------*/
+void TraversalWorkspace::reset(int nodeCount) {
+    if ((int)stamps.size() < nodeCount) {
+        // New entries start at stamp 0, which is never a live generation
+        stamps.resize(nodeCount, 0);
+        parents.resize(nodeCount);
+        distances.resize(nodeCount);
+    }
+
+    generation++;
+    if (generation == 0) {
+        // The counter wrapped: old stamps could look current again
+        fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
+    }
+    frontier.clear();
+}
+
+/*-----------------------------------------------------------------------
+    Get the calling thread's pool of idle workspaces.
+
+    Postcondition: Each thread has its own pool, freed when it exits.
+-----------------------------------------------------------------------*/
+vector<unique_ptr<TraversalWorkspace>>& TraversalWorkspace::pool() {
+    thread_local vector<unique_ptr<TraversalWorkspace>> idle;
+    return idle;
+}
@@ -0,0 +1,132 @@
+/******************************************************************************
+ * Class: TraversalWorkspace
+ *
+ * Description: Scratch arrays for one graph traversal (visited marks,
+ *              parents, distances and the BFS queue). Visited marks are
+ *              generation stamps: starting a new traversal only bumps the
+ *              current generation instead of clearing O(V) entries.
+ *              Workspaces are pooled per thread and handed out as leases,
+ *              so queries on different threads never share one and nested
+ *              traversals on the same thread each get their own.
+ *
+ * Member Variables:
+ *    - stamps: Generation in which each node was last visited
+ *    - parents: Node each visited node was reached from
+ *    - distances: Hop count of each visited node from the source
+ *    - frontier: BFS queue storage
+ *    - generation: Stamp of the current traversal
+ *
+ *****************************************************************************/
+
+#ifndef TRAVERSALWORKSPACE_H
+#define TRAVERSALWORKSPACE_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+using namespace std;
+
+class TraversalWorkspace {
+public:
+    /***** Lease Class (Returns the workspace to its pool when destroyed) *****/
+    class Lease {
+        TraversalWorkspace* workspace;
+    public:
+        /*** Constructer ***/
+        explicit Lease(TraversalWorkspace* workspace) : workspace(workspace) {}
+        Lease(Lease&& other) : workspace(other.workspace) { other.workspace = nullptr; }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+        /*-------------------------------------------------------------------
+          Hold a workspace taken from the calling thread's pool.
+
+          Postcondition: The workspace goes back to the pool of the calling
+                         thread when the lease is destroyed.
+         ------------------------------------------------------------------*/
+
+        TraversalWorkspace* operator->() const { return workspace; }
+        TraversalWorkspace& operator*() const { return *workspace; }
+    };
+
+    static Lease acquire(int nodeCount);
+    /*-------------------------------------------------------------------
+      Take a workspace from the calling thread's pool and start a new
+      traversal on it.
+
+      Precondition:  nodeCount is the size of the node ID space to traverse.
+      Postcondition: Returns a lease on a workspace with no node visited.
+                     Costs O(1) unless the graph grew since last use.
+     ------------------------------------------------------------------*/
+
+    /*** Traversal State **/
+    bool visited(int id) const { return stamps[id] == generation; }
+    /*-------------------------------------------------------------------
+      Check if a node was visited in the current traversal.
+
+      Precondition:  id is below the nodeCount given to acquire().
+      Postcondition: Returns true once visit() or block() was called on id.
+     ------------------------------------------------------------------*/
+
+    void visit(int id, int parent, int distance) {
+        stamps[id] = generation;
+        parents[id] = parent;
+        distances[id] = distance;
+    }
+    /*-------------------------------------------------------------------
+      Mark a node as visited.
+
+      Precondition:  id is below the nodeCount given to acquire().
+      Postcondition: id is visited with the given parent (-1 for the source)
+                     and distance.
+     ------------------------------------------------------------------*/
+
+    void block(int id) { visit(id, -1, -1); }
+    /*-------------------------------------------------------------------
+      Exclude a node from the current traversal.
+
+      Precondition:  id is below the nodeCount given to acquire().
+      Postcondition: id counts as visited, so it is never enqueued.
+     ------------------------------------------------------------------*/
+
+    int parent(int id) const { return parents[id]; }
+    int distance(int id) const { return distances[id]; }
+    /*-------------------------------------------------------------------
+      Get the parent and distance recorded for a visited node.
+
+      Precondition:  visited(id) is true.
+     ------------------------------------------------------------------*/
+
+    vector<int>& queue() { return frontier; }
+    /*-------------------------------------------------------------------
+      Get the BFS queue storage.
+
+      Postcondition: The queue is empty at the start of each traversal and
+                     keeps its capacity between traversals.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    vector<uint32_t> stamps;    // Visit generation of each node
+    vector<int> parents;        // Parent of each visited node
+    vector<int> distances;      // Distance of each visited node
+    vector<int> frontier;       // BFS queue
+    uint32_t generation = 0;    // Current traversal's stamp
+
+    /***** Helper Functions *****/
+    void reset(int nodeCount);
+    /*-----------------------------------------------------------------------
+      Start a new traversal.
+
+      Precondition:  nodeCount is the size of the node ID space.
+      Postcondition: No node is visited and the queue is empty.
+     ----------------------------------------------------------------------*/
+
+    static vector<unique_ptr<TraversalWorkspace>>& pool();
+    /*-----------------------------------------------------------------------
+      Get the calling thread's pool of idle workspaces.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
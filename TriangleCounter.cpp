@@ -0,0 +1,167 @@
+/*-------------------------------------------------------------------------
+  TriangleCounter.cpp
+
+  - Implementation of the non-template functions mentioned in TriangleCounter.h
+------------------------------------------------------------------------*/
+#include "TriangleCounter.h"
+#include "ParallelChunks.h"
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+namespace {
+    // Lists this many times longer than the other are searched instead of
+    // merged
+    const int GallopRatio = 32;
+
+    /*-----------------------------------------------------------------------
+        Intersect two sorted lists.
+
+        Postcondition: Calls found(x) for every x in both lists, in order.
+    -----------------------------------------------------------------------*/
+    template <class Found>
+    void intersect(const int* a, const int* aEnd, const int* b, const int* bEnd, Found found) {
+        if (aEnd - a > bEnd - b) {
+            swap(a, b);
+            swap(aEnd, bEnd);
+        }
+        if ((bEnd - b) > GallopRatio * (aEnd - a)) {
+            // Few short-list entries: binary search each one, narrowing
+            // the range of the long list as we go
+            for (; a < aEnd && b < bEnd; a++) {
+                b = lower_bound(b, bEnd, *a);
+                if (b < bEnd && *b == *a) found(*a);
+            }
+            return;
+        }
+        while (a < aEnd && b < bEnd) {
+            if (*a < *b) a++;
+            else if (*b < *a) b++;
+            else {
+                found(*a);
+                a++;
+                b++;
+            }
+        }
+    }
+
+}
+
+/*-----------------------------------------------------------------------
+    Count the triangles of a graph given by its friend lists.
+
+    Postcondition: perNode, degrees and total hold the counts.
+-----------------------------------------------------------------------*/
+void TriangleCounter::count(const FriendLists& lists, int threadCount) {
+    int nodes = lists.nodeCount();
+    perNode.assign(nodes, 0);
+    degrees.resize(nodes);
+    for (int id = 0; id < nodes; id++) {
+        degrees[id] = lists.degree(id);
+    }
+    total = 0;
+
+    threadCount = ParallelChunks::threadsFor(nodes, threadCount);
+
+    // Keep only the friends that are more connected (or equally connected
+    // with a larger ID), sorted so lists can be merged
+    auto before = [this](int a, int b) {
+        return degrees[a] < degrees[b] || (degrees[a] == degrees[b] && a < b);
+    };
+    vector<int> outOffsets(nodes + 1, 0);
+    for (int u = 0; u < nodes; u++) {
+        int kept = 0;
+        for (int i = lists.offsets[u]; i < lists.offsets[u + 1]; i++) {
+            if (before(u, lists.targets[i])) kept++;
+        }
+        outOffsets[u + 1] = outOffsets[u] + kept;
+    }
+    vector<int> outTargets(outOffsets[nodes]);
+    ParallelChunks::run(nodes, threadCount, [&](int, int start, int end) {
+        for (int u = start; u < end; u++) {
+            int* out = outTargets.data() + outOffsets[u];
+            for (int i = lists.offsets[u]; i < lists.offsets[u + 1]; i++) {
+                if (before(u, lists.targets[i])) *out++ = lists.targets[i];
+            }
+            sort(outTargets.begin() + outOffsets[u], outTargets.begin() + outOffsets[u + 1]);
+        }
+    });
+
+    // The thread claiming u adds its own count once per person; the other
+    // two corners of a triangle may be counted by any thread
+    vector<atomic<uint64_t>> corners(nodes);
+    for (atomic<uint64_t>& corner : corners) {
+        corner.store(0, memory_order_relaxed);
+    }
+    atomic<uint64_t> found(0);
+
+    ParallelChunks::run(nodes, threadCount, [&](int, int start, int end) {
+        uint64_t local = 0;
+        for (int u = start; u < end; u++) {
+            const int* uBegin = outTargets.data() + outOffsets[u];
+            const int* uEnd = outTargets.data() + outOffsets[u + 1];
+            uint64_t atU = 0;
+            for (const int* v = uBegin; v < uEnd; v++) {
+                const int* vBegin = outTargets.data() + outOffsets[*v];
+                const int* vEnd = outTargets.data() + outOffsets[*v + 1];
+                uint64_t atV = 0;
+                intersect(uBegin, uEnd, vBegin, vEnd, [&](int w) {
+                    atV++;
+                    corners[w].fetch_add(1, memory_order_relaxed);
+                });
+                if (atV) corners[*v].fetch_add(atV, memory_order_relaxed);
+                atU += atV;
+            }
+            if (atU) corners[u].fetch_add(atU, memory_order_relaxed);
+            local += atU;
+        }
+        found.fetch_add(local, memory_order_relaxed);
+    });
+
+    for (int id = 0; id < nodes; id++) {
+        perNode[id] = corners[id].load(memory_order_relaxed);
+    }
+    total = found.load(memory_order_relaxed);
+}
+
+/*-----------------------------------------------------------------------
+    Get the share of a person's pairs of friends who are friends too.
+
+    Precondition:  id is below nodeCount().
+    Postcondition: Returns 0 with fewer than two friends.
+-----------------------------------------------------------------------*/
+double TriangleCounter::localClustering(int id) const {
+    double d = degrees[id];
+    if (d < 2) return 0.0;
+    return 2.0 * perNode[id] / (d * (d - 1));
+}
+
+/*-----------------------------------------------------------------------
+    Get the mean local clustering coefficient.
+
+    Postcondition: Averages over people with at least two friends.
+-----------------------------------------------------------------------*/
+double TriangleCounter::averageClustering() const {
+    double sum = 0.0;
+    int counted = 0;
+    for (int id = 0; id < nodeCount(); id++) {
+        if (degrees[id] < 2) continue;
+        sum += localClustering(id);
+        counted++;
+    }
+    return counted == 0 ? 0.0 : sum / counted;
+}
+
+/*-----------------------------------------------------------------------
+    Get the transitivity of the graph.
+
+    Postcondition: Returns 3 x triangles / connected triples.
+-----------------------------------------------------------------------*/
+double TriangleCounter::globalClustering() const {
+    double triples = 0.0;
+    for (int d : degrees) {
+        triples += (double)d * (d - 1) / 2.0;
+    }
+    return triples == 0.0 ? 0.0 : 3.0 * total / triples;
+}
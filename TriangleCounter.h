@@ -0,0 +1,99 @@
+/******************************************************************************
+ * Class: TriangleCounter
+ *
+ * Description: Exact triangle counts and clustering coefficients. Every
+ *              friendship is oriented from the less to the more connected
+ *              person (ties broken by node ID), which leaves each person
+ *              with at most O(sqrt(E)) outgoing friends. A triangle is then
+ *              found exactly once, as a common outgoing friend of the two
+ *              ends of an oriented edge, by intersecting two short sorted
+ *              lists. People are split over threads in small chunks that
+ *              idle threads claim, since the work per person is uneven.
+ *
+ *              Node IDs are those of the graph view the counts were taken
+ *              from (SocialGraph::Snapshot or GraphSnapshot).
+ *
+ * Member Variables:
+ *    - perNode: Triangles each person is part of
+ *    - degrees: Number of friends of each person
+ *    - total: Triangles in the whole graph
+ *
+ *****************************************************************************/
+
+#ifndef TRIANGLECOUNTER_H
+#define TRIANGLECOUNTER_H
+
+#include "FriendLists.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class TriangleCounter {
+public:
+    /*** Constructer ***/
+    template <class Graph>
+    explicit TriangleCounter(const Graph& graph, int threadCount = 0) : total(0) {
+        // Orienting the friend lists needs random access, so count on a copy
+        count(FriendLists(graph), threadCount);
+    }
+    /*-------------------------------------------------------------------
+      Count the triangles of a graph.
+
+      Precondition:  threadCount of 0 uses one thread per hardware thread.
+      Postcondition: Every triangle is counted once in total and once for
+                     each of its three people.
+     ------------------------------------------------------------------*/
+
+    /*** Getters **/
+    int nodeCount() const { return (int)perNode.size(); }
+    uint64_t triangleCount() const { return total; }
+    uint64_t triangleCount(int id) const { return perNode[id]; }
+    /*-------------------------------------------------------------------
+      Get the number of triangles in the graph, or around one node ID.
+
+      Precondition:  id is below nodeCount().
+     ------------------------------------------------------------------*/
+
+    /*** Clustering Coefficients **/
+    double localClustering(int id) const;
+    /*-------------------------------------------------------------------
+      Get the share of a person's pairs of friends who are friends too.
+
+      Precondition:  id is below nodeCount().
+      Postcondition: Returns 2T / (d(d-1)) for d friends and T triangles,
+                     or 0 with fewer than two friends.
+     ------------------------------------------------------------------*/
+
+    double averageClustering() const;
+    /*-------------------------------------------------------------------
+      Get the mean local clustering coefficient.
+
+      Postcondition: Averages over people with at least two friends;
+                     returns 0 if there are none.
+     ------------------------------------------------------------------*/
+
+    double globalClustering() const;
+    /*-------------------------------------------------------------------
+      Get the transitivity of the graph.
+
+      Postcondition: Returns 3 x triangles / connected triples, or 0 if
+                     nobody has two friends.
+     ------------------------------------------------------------------*/
+
+private:
+    /***** Data Members *****/
+    vector<uint64_t> perNode;       // Triangles around each node ID
+    vector<int> degrees;            // Friends of each node ID
+    uint64_t total;                 // Triangles in the graph
+
+    /***** Helper Functions *****/
+    void count(const FriendLists& lists, int threadCount);
+    /*-----------------------------------------------------------------------
+      Count the triangles of a graph given by its friend lists.
+
+      Postcondition: perNode, degrees and total hold the counts.
+     ----------------------------------------------------------------------*/
+};
+
+#endif
@@ -300,15 +300,14 @@ void saveToFile(SocialGraph& graph) {
 -------------------------------------------------------------------*/
 void displayAllPeople(const SocialGraph& graph) {
     cout << "\nPeople in the network:\n";
-    vector<SocialGraph::Node> people = graph.getNodes();
-    if (people.empty()) {
+    bool hasPeople = false;
+    graph.forEachPerson([&hasPeople](string_view name) {
+        hasPeople = true;
+        cout << "- " << name << endl;
+    });
+    if (!hasPeople) {
         cout << "No people in the network.\n";
     }
-    else {
-        for (int i = 0; i < people.size(); i++) {
-            cout << "- " << people[i].getName() << endl;
-        }
-    }
 }
 
 /*-------------------------------------------------------------------
@@ -320,20 +319,22 @@ void displayAllPeople(const SocialGraph& graph) {
 -------------------------------------------------------------------*/
 void displayAllFriendships(const SocialGraph& graph) {
     cout << "\nFriendships in the network:\n";
-    vector<SocialGraph::Node> nodes = graph.getNodes();
     bool hasFriendships = false;
 
-    for (int i = 0; i < nodes.size(); i++) {
-        SocialGraph::Node current = nodes[i];
-        vector<SocialGraph::Node> friends = graph.getFriends(current);
+    // Walk one version's own storage instead of copying node and friend
+    // lists; the snapshot keeps the views valid while writers carry on
+    SocialGraph::Snapshot version = graph.snapshot();
+    for (int id = 0; id < version.nodeCount(); id++) {
+        if (!version.isPerson(id)) continue;
+        SocialGraph::FriendRange friends = version.neighbors(id);
 
         if (!friends.empty()) {
             hasFriendships = true;
         }
 
-        cout << current.getName() << ": ";
+        cout << version.nameOf(id) << ": ";
         for (int j = 0; j < friends.size(); j++) {
-            cout << friends[j].getName();
+            cout << version.nameOf(friends[j]);
             if (j != friends.size() - 1) {
                 cout << " ";
             }